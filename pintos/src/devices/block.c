@@ -16,8 +16,10 @@ struct block {
   const struct block_operations* ops; /* Driver operations. */
   void* aux;                          /* Extra data owned by driver. */
 
-  unsigned long long read_cnt;  /* Number of sectors read. */
-  unsigned long long write_cnt; /* Number of sectors written. */
+  unsigned long long read_cnt;      /* Number of sectors read. */
+  unsigned long long write_cnt;     /* Number of sectors written. */
+  unsigned long long read_req_cnt;  /* Number of read requests. */
+  unsigned long long write_req_cnt; /* Number of write requests. */
 };
 
 /* List of all block devices. */
@@ -90,6 +92,14 @@ static void check_sector(struct block* block, block_sector_t sector) {
   }
 }
 
+/* Verifies that the CNT sectors starting at SECTOR all lie
+   within BLOCK.  Panics if not. */
+static void check_sectors(struct block* block, block_sector_t sector, size_t cnt) {
+  check_sector(block, sector);
+  if (cnt > block->size - sector)
+    check_sector(block, block->size);
+}
+
 /* Reads sector SECTOR from BLOCK into BUFFER, which must
    have room for BLOCK_SECTOR_SIZE bytes.
    Internally synchronizes accesses to block devices, so external
@@ -98,6 +108,7 @@ void block_read(struct block* block, block_sector_t sector, void* buffer) {
   check_sector(block, sector);
   block->ops->read(block->aux, sector, buffer);
   block->read_cnt++;
+  block->read_req_cnt++;
 }
 
 /* Write sector SECTOR to BLOCK from BUFFER, which must contain
@@ -110,8 +121,116 @@ void block_write(struct block* block, block_sector_t sector, const void* buffer)
   ASSERT(block->type != BLOCK_FOREIGN);
   block->ops->write(block->aux, sector, buffer);
   block->write_cnt++;
+  block->write_req_cnt++;
+}
+
+/* Reads CNT consecutive sectors starting at SECTOR from BLOCK
+   into BUFFER, which must have room for CNT * BLOCK_SECTOR_SIZE
+   bytes.  Uses as few driver requests as the driver allows.
+   Internally synchronizes accesses to block devices, so external
+   per-block device locking is unneeded. */
+void block_read_multiple(struct block* block, block_sector_t sector, size_t cnt, void* buffer_) {
+  uint8_t* buffer = buffer_;
+
+  check_sectors(block, sector, cnt);
+  while (cnt > 0) {
+    size_t n = cnt < BLOCK_MULTIPLE_MAX ? cnt : BLOCK_MULTIPLE_MAX;
+    if (block->ops->read_multiple != NULL) {
+      block->ops->read_multiple(block->aux, sector, n, buffer);
+      block->read_req_cnt++;
+    } else {
+      size_t i;
+      for (i = 0; i < n; i++)
+        block->ops->read(block->aux, sector + i, buffer + i * BLOCK_SECTOR_SIZE);
+      block->read_req_cnt += n;
+    }
+    block->read_cnt += n;
+    sector += n;
+    buffer += n * BLOCK_SECTOR_SIZE;
+    cnt -= n;
+  }
+}
+
+/* Writes CNT consecutive sectors starting at SECTOR to BLOCK
+   from BUFFER, which must contain CNT * BLOCK_SECTOR_SIZE bytes.
+   Returns after the block device has acknowledged receiving all
+   the data.  Uses as few driver requests as the driver allows.
+   Internally synchronizes accesses to block devices, so external
+   per-block device locking is unneeded. */
+void block_write_multiple(struct block* block, block_sector_t sector, size_t cnt,
+                          const void* buffer_) {
+  const uint8_t* buffer = buffer_;
+
+  check_sectors(block, sector, cnt);
+  ASSERT(block->type != BLOCK_FOREIGN);
+  while (cnt > 0) {
+    size_t n = cnt < BLOCK_MULTIPLE_MAX ? cnt : BLOCK_MULTIPLE_MAX;
+    if (block->ops->write_multiple != NULL) {
+      block->ops->write_multiple(block->aux, sector, n, buffer);
+      block->write_req_cnt++;
+    } else {
+      size_t i;
+      for (i = 0; i < n; i++)
+        block->ops->write(block->aux, sector + i, buffer + i * BLOCK_SECTOR_SIZE);
+      block->write_req_cnt += n;
+    }
+    block->write_cnt += n;
+    sector += n;
+    buffer += n * BLOCK_SECTOR_SIZE;
+    cnt -= n;
+  }
+}
+
+/* Initializes R as a request to read (or, if WRITE is true,
+   write) CNT sectors starting at SECTOR into (or from) BUFFER.
+   COMPLETE, if nonnull, will be called with R when the request
+   is done; AUX is stored in R for its use. */
+void block_request_init(struct block_request* r, bool write, block_sector_t sector, size_t cnt,
+                        void* buffer, void (*complete)(struct block_request*), void* aux) {
+  ASSERT(cnt >= 1 && cnt <= BLOCK_MULTIPLE_MAX);
+
+  r->sector = sector;
+  r->cnt = cnt;
+  r->buffer = buffer;
+  r->write = write;
+  r->complete = complete;
+  r->aux = aux;
+  sema_init(&r->done, 0);
 }
 
+/* Submits request R to BLOCK and returns, usually before the
+   request is done.  The driver may reorder R relative to other
+   requests and combine it with requests for adjacent sectors. */
+void block_submit(struct block* block, struct block_request* r) {
+  check_sectors(block, r->sector, r->cnt);
+  if (r->write) {
+    ASSERT(block->type != BLOCK_FOREIGN);
+    block->write_cnt += r->cnt;
+    block->write_req_cnt++;
+  } else {
+    block->read_cnt += r->cnt;
+    block->read_req_cnt++;
+  }
+
+  if (block->ops->submit != NULL)
+    block->ops->submit(block->aux, r);
+  else {
+    size_t i;
+    for (i = 0; i < r->cnt; i++) {
+      uint8_t* sector_buffer = (uint8_t*)r->buffer + i * BLOCK_SECTOR_SIZE;
+      if (r->write)
+        block->ops->write(block->aux, r->sector + i, sector_buffer);
+      else
+        block->ops->read(block->aux, r->sector + i, sector_buffer);
+    }
+    block_complete(r);
+  }
+}
+
+/* Waits for request R, which must have been submitted, to be
+   done. */
+void block_wait(struct block_request* r) { sema_down(&r->done); }
+
 /* Returns the number of sectors in BLOCK. */
 block_sector_t block_size(struct block* block) { return block->size; }
 
@@ -128,8 +247,9 @@ void block_print_stats(void) {
   for (i = 0; i < BLOCK_ROLE_CNT; i++) {
     struct block* block = block_by_role[i];
     if (block != NULL) {
-      printf("%s (%s): %llu reads, %llu writes\n", block->name, block_type_name(block->type),
-             block->read_cnt, block->write_cnt);
+      printf("%s (%s): %llu reads in %llu requests, %llu writes in %llu requests\n", block->name,
+             block_type_name(block->type), block->read_cnt, block->read_req_cnt, block->write_cnt,
+             block->write_req_cnt);
     }
   }
 }
@@ -153,6 +273,8 @@ struct block* block_register(const char* name, enum block_type type, const char*
   block->aux = aux;
   block->read_cnt = 0;
   block->write_cnt = 0;
+  block->read_req_cnt = 0;
+  block->write_req_cnt = 0;
 
   printf("%s: %'" PRDSNu " sectors (", block->name, block->size);
   print_human_readable_size((uint64_t)block->size * BLOCK_SECTOR_SIZE);
@@ -164,6 +286,14 @@ struct block* block_register(const char* name, enum block_type type, const char*
   return block;
 }
 
+/* Called by a block device driver when request R is done.
+   May be called from an interrupt handler. */
+void block_complete(struct block_request* r) {
+  if (r->complete != NULL)
+    r->complete(r);
+  sema_up(&r->done);
+}
+
 /* Returns the block device corresponding to LIST_ELEM, or a null
    pointer if LIST_ELEM is the list end of all_blocks. */
 static struct block* list_elem_to_block(struct list_elem* list_elem) {
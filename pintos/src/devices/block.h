@@ -1,8 +1,11 @@
 #ifndef DEVICES_BLOCK_H
 #define DEVICES_BLOCK_H
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <inttypes.h>
+#include <list.h>
+#include "threads/synch.h"
 
 /* Size of a block device sector in bytes.
    All IDE disks use this sector size, as do most USB and SCSI
@@ -52,20 +55,66 @@ struct block* block_next(struct block*);
 block_sector_t block_size(struct block*);
 void block_read(struct block*, block_sector_t, void*);
 void block_write(struct block*, block_sector_t, const void*);
+void block_read_multiple(struct block*, block_sector_t, size_t cnt, void*);
+void block_write_multiple(struct block*, block_sector_t, size_t cnt, const void*);
 const char* block_name(struct block*);
 enum block_type block_type(struct block*);
 
+/* Asynchronous block device request.
+
+   A request is submitted with block_submit(), after which the
+   caller may continue with other work.  When the transfer is
+   done, COMPLETE (if nonnull) is called and then DONE is up'd,
+   so the caller may instead simply wait with block_wait().
+   COMPLETE may be called from an interrupt handler, so it must
+   not sleep.  The request must stay in place until then.
+
+   The transfer may take place while another process is running,
+   so BUFFER must be a kernel address. */
+struct block_request {
+  struct list_elem elem; /* For use by the driver. */
+  block_sector_t sector; /* First sector, translated in place by partitions. */
+  size_t cnt;            /* Number of sectors, at most BLOCK_MULTIPLE_MAX. */
+  void* buffer;          /* CNT * BLOCK_SECTOR_SIZE bytes, in kernel memory. */
+  bool write;            /* True to write, false to read. */
+  void (*complete)(struct block_request*); /* Completion callback, or null. */
+  void* aux;                               /* For use by COMPLETE. */
+  struct semaphore done;                   /* Up'd when the request is done. */
+};
+
+void block_request_init(struct block_request*, bool write, block_sector_t, size_t cnt,
+                        void* buffer, void (*complete)(struct block_request*), void* aux);
+void block_submit(struct block*, struct block_request*);
+void block_wait(struct block_request*);
+
 /* Statistics. */
 void block_print_stats(void);
 
 /* Lower-level interface to block device drivers. */
 
+/* Maximum number of sectors in a single multi-sector request
+   passed to a driver.  Larger requests are split by block.c. */
+#define BLOCK_MULTIPLE_MAX 256
+
+/* READ_MULTIPLE and WRITE_MULTIPLE transfer CNT consecutive
+   sectors, 1 <= CNT <= BLOCK_MULTIPLE_MAX, in one request.  A
+   driver that cannot do better than one sector at a time may
+   leave them null.
+
+   SUBMIT queues a request and returns at once, calling
+   block_complete() when the request is done.  A driver that
+   cannot queue requests may leave it null, in which case
+   block_submit() does the transfer synchronously. */
 struct block_operations {
   void (*read)(void* aux, block_sector_t, void* buffer);
   void (*write)(void* aux, block_sector_t, const void* buffer);
+  void (*read_multiple)(void* aux, block_sector_t, size_t cnt, void* buffer);
+  void (*write_multiple)(void* aux, block_sector_t, size_t cnt, const void* buffer);
+  void (*submit)(void* aux, struct block_request*);
 };
 
 struct block* block_register(const char* name, enum block_type, const char* extra_info,
                              block_sector_t size, const struct block_operations*, void* aux);
+void block_complete(struct block_request*);
 
 #endif /* devices/block.h */
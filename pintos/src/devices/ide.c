@@ -3,15 +3,24 @@
 #include <debug.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <string.h>
 #include "devices/block.h"
 #include "devices/partition.h"
+#include "devices/pci.h"
 #include "devices/timer.h"
 #include "threads/io.h"
 #include "threads/interrupt.h"
+#include "threads/palloc.h"
 #include "threads/synch.h"
+#include "threads/vaddr.h"
 
 /* The code in this file is an interface to an ATA (IDE)
-   controller.  It attempts to comply to [ATA-3]. */
+   controller.  It attempts to comply to [ATA-3].
+
+   If the controller is a PCI bus master, as the PIIX that QEMU
+   and Bochs emulate is, data moves by DMA and the disk interrupts
+   once per command.  Otherwise the CPU copies data through the
+   data register a sector at a time (PIO). */
 
 /* ATA command block port addresses. */
 #define reg_data(CHANNEL) ((CHANNEL)->reg_base + 0)   /* Data. */
@@ -30,14 +39,40 @@
 #define reg_ctl(CHANNEL) ((CHANNEL)->reg_base + 0x206) /* Control (w/o). */
 #define reg_alt_status(CHANNEL) reg_ctl(CHANNEL)       /* Alt Status (r/o). */
 
+/* Bus master IDE port addresses, relative to the channel's
+   bus master base. */
+#define reg_bm_command(CHANNEL) ((CHANNEL)->bm_base + 0) /* Command. */
+#define reg_bm_status(CHANNEL) ((CHANNEL)->bm_base + 2)  /* Status. */
+#define reg_bm_prdt(CHANNEL) ((CHANNEL)->bm_base + 4)    /* PRD table address. */
+
+/* Bus master Command Register bits. */
+#define BMC_START 0x01 /* Start transfer. */
+#define BMC_READ 0x08  /* Transfer from disk to memory. */
+
+/* Bus master Status Register bits. */
+#define BMS_ERR 0x02  /* Error (write 1 to clear). */
+#define BMS_INTR 0x04 /* Interrupt (write 1 to clear). */
+
+/* PCI class and subclass of IDE controllers, and the bit in
+   their programming interface byte that marks a bus master. */
+#define PCI_CLASS_STORAGE 0x01
+#define PCI_SUBCLASS_IDE 0x01
+#define PCI_IDE_BUS_MASTER 0x80
+
 /* Alternate Status Register bits. */
 #define STA_BSY 0x80  /* Busy. */
 #define STA_DRDY 0x40 /* Device Ready. */
 #define STA_DRQ 0x08  /* Data Request. */
+#define STA_ERR 0x01  /* Error. */
 
 /* Control Register bits. */
 #define CTL_SRST 0x04 /* Software Reset. */
 
+/* Number of times to poll a status register before starting to
+   wait between polls.  An emulated disk usually finishes within
+   a few polls, well before the shortest wait would have ended. */
+#define SPIN_CNT 100
+
 /* Device Register bits. */
 #define DEV_MBS 0xa0 /* Must be set. */
 #define DEV_LBA 0x40 /* Linear based addressing. */
@@ -49,6 +84,18 @@
 #define CMD_IDENTIFY_DEVICE 0xec    /* IDENTIFY DEVICE. */
 #define CMD_READ_SECTOR_RETRY 0x20  /* READ SECTOR with retries. */
 #define CMD_WRITE_SECTOR_RETRY 0x30 /* WRITE SECTOR with retries. */
+#define CMD_READ_DMA 0xc8           /* READ DMA. */
+#define CMD_WRITE_DMA 0xca          /* WRITE DMA. */
+
+/* Physical Region Descriptor, an entry in the table that tells
+   a bus master where in memory to transfer data.  A region may
+   not cross a 64 kB boundary. */
+struct prd {
+  uint32_t addr;  /* Physical address. */
+  uint16_t size;  /* Size in bytes, with 0 meaning 64 kB. */
+  uint16_t flags; /* PRD_EOT if last entry in the table. */
+};
+#define PRD_EOT 0x8000
 
 /* An ATA device. */
 struct ata_disk {
@@ -56,6 +103,10 @@ struct ata_disk {
   struct channel* channel; /* Channel that disk is attached to. */
   int dev_no;              /* Device 0 or 1 for master or slave. */
   bool is_ata;             /* Is device an ATA disk? */
+  bool dma;                /* Does the device support DMA? */
+
+  struct list queue;   /* Pending requests, sorted by sector. */
+  block_sector_t head; /* Sector following the last command. */
 };
 
 /* An ATA channel (aka controller).
@@ -64,12 +115,28 @@ struct channel {
   char name[8];      /* Name, e.g. "ide0". */
   uint16_t reg_base; /* Base I/O port. */
   uint8_t irq;       /* Interrupt in use. */
+  uint16_t bm_base;  /* Bus master base I/O port, or 0 if none. */
+  struct prd* prdt;  /* PRD table, one page, if bus master. */
+
+  struct lock bounce_lock; /* Protects `bounce'. */
+  uint8_t* bounce;         /* Bounce buffer for user data, one page. */
 
-  struct lock lock;                 /* Must acquire to access the controller. */
   bool expecting_interrupt;         /* True if an interrupt is expected, false if
                                    any interrupt would be spurious. */
   struct semaphore completion_wait; /* Up'd by interrupt handler. */
 
+  /* Command in progress, if any.  See "Request queueing" below. */
+  struct ata_disk* active_disk; /* Disk being accessed, or null if idle. */
+  struct list active;           /* Requests merged into the command. */
+  bool active_write;            /* Writing (true) or reading (false)? */
+  bool active_dma;              /* Transferring by DMA? */
+  struct block_request* cur;    /* Request being transferred. */
+  size_t cur_ofs;               /* Sectors of CUR transferred so far. */
+  bool transfer_done;           /* All data sent, awaiting final interrupt? */
+  int last_dev_no;              /* Device of the previous command. */
+
+  int selected_dev_no; /* Device now selected, or -1 if unknown. */
+
   struct ata_disk devices[2]; /* The devices on this channel. */
 };
 
@@ -83,13 +150,29 @@ static void reset_channel(struct channel*);
 static bool check_device_type(struct ata_disk*);
 static void identify_ata_device(struct ata_disk*);
 
-static void select_sector(struct ata_disk*, block_sector_t);
+static void ide_read_multiple(void*, block_sector_t, size_t cnt, void*);
+static void ide_write_multiple(void*, block_sector_t, size_t cnt, const void*);
+static void ide_submit(void*, struct block_request*);
+static void transfer(struct ata_disk*, bool write, block_sector_t, size_t cnt, void*);
+
+static bool request_less(const struct list_elem*, const struct list_elem*, void* aux);
+static void start_command(struct channel*);
+static void continue_command(struct channel*);
+static bool advance_sector(struct channel*);
+static void finish_command(struct channel*);
+
+static uint16_t find_bus_master(void);
+static void load_prdt(struct channel*);
+static void finish_dma(struct channel*);
+
+static void select_sector(struct ata_disk*, block_sector_t, size_t cnt);
 static void issue_pio_command(struct channel*, uint8_t command);
 static void input_sector(struct channel*, void*);
 static void output_sector(struct channel*, const void*);
 
 static void wait_until_idle(const struct ata_disk*);
 static bool wait_while_busy(const struct ata_disk*);
+static bool wait_for_drq(struct channel*);
 static void select_device(const struct ata_disk*);
 static void select_device_wait(const struct ata_disk*);
 
@@ -97,6 +180,7 @@ static void interrupt_handler(struct intr_frame*);
 
 /* Initialize the disk subsystem and detect disks. */
 void ide_init(void) {
+  uint16_t bm_base = find_bus_master();
   size_t chan_no;
 
   for (chan_no = 0; chan_no < CHANNEL_CNT; chan_no++) {
@@ -117,9 +201,16 @@ void ide_init(void) {
       default:
         NOT_REACHED();
     }
-    lock_init(&c->lock);
+    c->bm_base = bm_base != 0 ? bm_base + chan_no * 8 : 0;
+    c->prdt = bm_base != 0 ? palloc_get_page(PAL_ASSERT) : NULL;
+    lock_init(&c->bounce_lock);
+    c->bounce = palloc_get_page(PAL_ASSERT);
     c->expecting_interrupt = false;
     sema_init(&c->completion_wait, 0);
+    c->active_disk = NULL;
+    list_init(&c->active);
+    c->last_dev_no = 1;
+    c->selected_dev_no = -1;
 
     /* Initialize devices. */
     for (dev_no = 0; dev_no < 2; dev_no++) {
@@ -128,6 +219,9 @@ void ide_init(void) {
       d->channel = c;
       d->dev_no = dev_no;
       d->is_ata = false;
+      d->dma = false;
+      list_init(&d->queue);
+      d->head = 0;
     }
 
     /* Register interrupt handler. */
@@ -183,6 +277,7 @@ static void reset_channel(struct channel* c) {
   outb(reg_ctl(c), CTL_SRST);
   timer_usleep(10);
   outb(reg_ctl(c), 0);
+  c->selected_dev_no = 0;
 
   timer_msleep(150);
 
@@ -260,6 +355,7 @@ static void identify_ata_device(struct ata_disk* d) {
   /* Calculate capacity.
      Read model name and serial number. */
   capacity = *(uint32_t*)&id[60 * 2];
+  d->dma = (*(uint16_t*)&id[49 * 2] & 0x0100) != 0;
   model = descramble_ata_string(&id[10 * 2], 20);
   serial = descramble_ata_string(&id[27 * 2], 40);
   snprintf(extra_info, sizeof extra_info, "model \"%s\", serial \"%s\"", model, serial);
@@ -310,17 +406,8 @@ static char* descramble_ata_string(char* string, int size) {
    room for BLOCK_SECTOR_SIZE bytes.
    Internally synchronizes accesses to disks, so external
    per-disk locking is unneeded. */
-static void ide_read(void* d_, block_sector_t sec_no, void* buffer) {
-  struct ata_disk* d = d_;
-  struct channel* c = d->channel;
-  lock_acquire(&c->lock);
-  select_sector(d, sec_no);
-  issue_pio_command(c, CMD_READ_SECTOR_RETRY);
-  sema_down(&c->completion_wait);
-  if (!wait_while_busy(d))
-    PANIC("%s: disk read failed, sector=%" PRDSNu, d->name, sec_no);
-  input_sector(c, buffer);
-  lock_release(&c->lock);
+static void ide_read(void* d, block_sector_t sec_no, void* buffer) {
+  ide_read_multiple(d, sec_no, 1, buffer);
 }
 
 /* Write sector SEC_NO to disk D from BUFFER, which must contain
@@ -328,31 +415,361 @@ static void ide_read(void* d_, block_sector_t sec_no, void* buffer) {
    acknowledged receiving the data.
    Internally synchronizes accesses to disks, so external
    per-disk locking is unneeded. */
-static void ide_write(void* d_, block_sector_t sec_no, const void* buffer) {
+static void ide_write(void* d, block_sector_t sec_no, const void* buffer) {
+  ide_write_multiple(d, sec_no, 1, buffer);
+}
+
+/* Number of sectors in a channel's bounce buffer. */
+#define BOUNCE_SECTORS (PGSIZE / BLOCK_SECTOR_SIZE)
+
+/* Reads CNT sectors starting at SEC_NO from disk D into BUFFER,
+   which must have room for CNT * BLOCK_SECTOR_SIZE bytes.
+   Internally synchronizes accesses to disks, so external
+   per-disk locking is unneeded. */
+static void ide_read_multiple(void* d_, block_sector_t sec_no, size_t cnt, void* buffer_) {
   struct ata_disk* d = d_;
   struct channel* c = d->channel;
-  lock_acquire(&c->lock);
-  select_sector(d, sec_no);
-  issue_pio_command(c, CMD_WRITE_SECTOR_RETRY);
-  if (!wait_while_busy(d))
-    PANIC("%s: disk write failed, sector=%" PRDSNu, d->name, sec_no);
-  output_sector(c, buffer);
-  sema_down(&c->completion_wait);
-  lock_release(&c->lock);
+  uint8_t* buffer = buffer_;
+  uint8_t* bounce = c->bounce;
+
+  if (is_kernel_vaddr(buffer)) {
+    transfer(d, false, sec_no, cnt, buffer);
+    return;
+  }
+
+  /* The transfer takes place in the interrupt handler, perhaps
+     while another process is running, so user memory has to be
+     copied through a kernel buffer.  Each channel has one, set
+     aside at initialization so that running short of memory
+     cannot make a read or write fail. */
+  lock_acquire(&c->bounce_lock);
+  while (cnt > 0) {
+    size_t n = cnt < BOUNCE_SECTORS ? cnt : BOUNCE_SECTORS;
+    transfer(d, false, sec_no, n, bounce);
+    memcpy(buffer, bounce, n * BLOCK_SECTOR_SIZE);
+    sec_no += n;
+    buffer += n * BLOCK_SECTOR_SIZE;
+    cnt -= n;
+  }
+  lock_release(&c->bounce_lock);
+}
+
+/* Writes CNT sectors starting at SEC_NO to disk D from BUFFER,
+   which must contain CNT * BLOCK_SECTOR_SIZE bytes.  Returns
+   after the disk has acknowledged receiving all the data.
+   Internally synchronizes accesses to disks, so external
+   per-disk locking is unneeded. */
+static void ide_write_multiple(void* d_, block_sector_t sec_no, size_t cnt, const void* buffer_) {
+  struct ata_disk* d = d_;
+  struct channel* c = d->channel;
+  const uint8_t* buffer = buffer_;
+  uint8_t* bounce = c->bounce;
+
+  if (is_kernel_vaddr(buffer)) {
+    transfer(d, true, sec_no, cnt, (void*)buffer);
+    return;
+  }
+
+  /* See ide_read_multiple(). */
+  lock_acquire(&c->bounce_lock);
+  while (cnt > 0) {
+    size_t n = cnt < BOUNCE_SECTORS ? cnt : BOUNCE_SECTORS;
+    memcpy(bounce, buffer, n * BLOCK_SECTOR_SIZE);
+    transfer(d, true, sec_no, n, bounce);
+    sec_no += n;
+    buffer += n * BLOCK_SECTOR_SIZE;
+    cnt -= n;
+  }
+  lock_release(&c->bounce_lock);
+}
+
+/* Reads (or, if WRITE is true, writes) CNT sectors starting at
+   SEC_NO on disk D into (or from) BUFFER, a kernel address, and
+   waits for the transfer to complete. */
+static void transfer(struct ata_disk* d, bool write, block_sector_t sec_no, size_t cnt,
+                     void* buffer) {
+  struct block_request r;
+
+  block_request_init(&r, write, sec_no, cnt, buffer, NULL, NULL);
+  ide_submit(d, &r);
+  block_wait(&r);
 }
 
-static struct block_operations ide_operations = {ide_read, ide_write};
+/* Queues request R for disk D and, if D's channel is idle,
+   starts it.  Returns without waiting for R to be done. */
+static void ide_submit(void* d_, struct block_request* r) {
+  struct ata_disk* d = d_;
+  struct channel* c = d->channel;
+  enum intr_level old_level;
+
+  ASSERT(r->sector + r->cnt <= (1UL << 28));
+  ASSERT(is_kernel_vaddr(r->buffer));
+
+  old_level = intr_disable();
+  list_insert_ordered(&d->queue, &r->elem, request_less, NULL);
+  if (c->active_disk == NULL)
+    start_command(c);
+  intr_set_level(old_level);
+}
+
+static struct block_operations ide_operations = {ide_read, ide_write, ide_read_multiple,
+                                                 ide_write_multiple, ide_submit};
+
+/* Request queueing.
+
+   Each disk keeps its pending requests in a queue sorted by
+   sector.  Whenever its channel goes idle, the channel takes the
+   next request from one of its disks, alternating between them,
+   in C-LOOK order: the request with the lowest sector at or
+   after the end of the disk's previous command, or, if there is
+   none, the lowest sector of all.  Requests that immediately
+   follow it on the disk, in the same direction, are merged into
+   the same command, up to BLOCK_MULTIPLE_MAX sectors.
+   Overlapping requests outstanding at the same time may be
+   served in either order.
+
+   The command then runs from interrupt_handler(), one sector per
+   interrupt with PIO or all at once with DMA, and the next one
+   is started from there when it completes.  Queues and command
+   state are accessed only with interrupts off. */
+
+/* Orders requests by sector.  list_insert_ordered() puts a
+   request after those that compare equal to it, so requests for
+   the same sector stay in order of submission. */
+static bool request_less(const struct list_elem* a_, const struct list_elem* b_,
+                         void* aux UNUSED) {
+  const struct block_request* a = list_entry(a_, struct block_request, elem);
+  const struct block_request* b = list_entry(b_, struct block_request, elem);
+  return a->sector < b->sector;
+}
+
+/* If any requests are queued on channel C, which must be idle,
+   starts a command for the next of them. */
+static void start_command(struct channel* c) {
+  struct ata_disk* d = NULL;
+  struct block_request* r;
+  struct list_elem* e;
+  block_sector_t start;
+  size_t cnt;
+  int i;
+
+  ASSERT(intr_get_level() == INTR_OFF);
+  ASSERT(c->active_disk == NULL);
+
+  /* Choose a disk, preferring the one not served last. */
+  for (i = 1; i <= 2 && d == NULL; i++) {
+    struct ata_disk* candidate = &c->devices[(c->last_dev_no + i) % 2];
+    if (!list_empty(&candidate->queue))
+      d = candidate;
+  }
+  if (d == NULL)
+    return;
+  c->last_dev_no = d->dev_no;
+
+  /* Choose a request. */
+  for (e = list_begin(&d->queue); e != list_end(&d->queue); e = list_next(e))
+    if (list_entry(e, struct block_request, elem)->sector >= d->head)
+      break;
+  if (e == list_end(&d->queue))
+    e = list_begin(&d->queue);
+
+  /* Move it and any requests it can be merged with to the
+     channel's active list. */
+  r = list_entry(e, struct block_request, elem);
+  start = r->sector;
+  c->active_write = r->write;
+  cnt = 0;
+  while (e != list_end(&d->queue)) {
+    r = list_entry(e, struct block_request, elem);
+    if (r->write != c->active_write || r->sector != start + cnt ||
+        cnt + r->cnt > BLOCK_MULTIPLE_MAX)
+      break;
+    e = list_remove(e);
+    list_push_back(&c->active, &r->elem);
+    cnt += r->cnt;
+  }
+  d->head = start + cnt;
+
+  c->active_disk = d;
+  c->cur = list_entry(list_front(&c->active), struct block_request, elem);
+  c->cur_ofs = 0;
+  c->transfer_done = false;
+  c->active_dma = c->bm_base != 0 && d->dma;
+
+  /* With DMA, the bus master moves all the data, and the disk
+     interrupts once at the end. */
+  if (c->active_dma) {
+    uint8_t direction = c->active_write ? 0 : BMC_READ;
+
+    load_prdt(c);
+    outb(reg_bm_command(c), direction);
+    outb(reg_bm_status(c), inb(reg_bm_status(c)) | BMS_ERR | BMS_INTR);
+    select_sector(d, start, cnt);
+    outb(reg_command(c), c->active_write ? CMD_WRITE_DMA : CMD_READ_DMA);
+    outb(reg_bm_command(c), direction | BMC_START);
+    return;
+  }
+
+  /* With PIO, a write's first sector is sent right away; each
+     later sector follows the interrupt for the one before it. */
+  select_sector(d, start, cnt);
+  outb(reg_command(c), c->active_write ? CMD_WRITE_SECTOR_RETRY : CMD_READ_SECTOR_RETRY);
+  if (c->active_write) {
+    if (!wait_for_drq(c))
+      PANIC("%s: disk write failed, sector=%" PRDSNu, d->name, start);
+    output_sector(c, c->cur->buffer);
+    c->transfer_done = advance_sector(c);
+  }
+}
+
+/* Carries on with the command in progress on channel C, whose
+   disk has just interrupted. */
+static void continue_command(struct channel* c) {
+  struct ata_disk* d = c->active_disk;
+  uint8_t* buffer = (uint8_t*)c->cur->buffer + c->cur_ofs * BLOCK_SECTOR_SIZE;
+  uint8_t status;
+
+  if (c->active_dma) {
+    finish_dma(c);
+    return;
+  }
+
+  status = inb(reg_status(c)); /* Acknowledges the interrupt. */
+
+  if ((status & STA_ERR) != 0 || (!c->transfer_done && (status & STA_DRQ) == 0))
+    PANIC("%s: disk %s failed, sector=%" PRDSNu, d->name, c->active_write ? "write" : "read",
+          c->cur->sector + c->cur_ofs);
+
+  if (c->transfer_done)
+    finish_command(c);
+  else if (c->active_write) {
+    output_sector(c, buffer);
+    c->transfer_done = advance_sector(c);
+  } else {
+    input_sector(c, buffer);
+    if (advance_sector(c))
+      finish_command(c);
+  }
+}
+
+/* Moves channel C's transfer position past the sector just
+   transferred.  Returns true if that was the command's last
+   sector. */
+static bool advance_sector(struct channel* c) {
+  struct list_elem* next;
+
+  if (++c->cur_ofs < c->cur->cnt)
+    return false;
+  next = list_next(&c->cur->elem);
+  if (next == list_end(&c->active))
+    return true;
+  c->cur = list_entry(next, struct block_request, elem);
+  c->cur_ofs = 0;
+  return false;
+}
+
+/* Completes the requests in channel C's finished command, then
+   starts the next command. */
+static void finish_command(struct channel* c) {
+  c->active_disk = NULL;
+  while (!list_empty(&c->active))
+    block_complete(list_entry(list_pop_front(&c->active), struct block_request, elem));
+  start_command(c);
+}
+
+/* Bus master DMA. */
+
+/* Looks for a PCI IDE controller that can act as a bus master
+   and that uses the legacy ports and interrupts for both of its
+   channels.  If one is found, enables its bus mastering and
+   returns its bus master base I/O port.  Otherwise, returns 0,
+   and the disks will be accessed with PIO. */
+static uint16_t find_bus_master(void) {
+  struct pci_addr addr;
+  uint32_t class_reg, bar;
+
+  if (!pci_find_class(PCI_CLASS_STORAGE, PCI_SUBCLASS_IDE, &addr))
+    return 0;
+
+  /* Programming interface bits 0 and 2 select native mode for
+     the primary and secondary channels. */
+  class_reg = pci_read_config(addr, PCI_REG_CLASS);
+  if ((class_reg & (PCI_IDE_BUS_MASTER << 8)) == 0 || (class_reg & 0x0500) != 0)
+    return 0;
+
+  /* BAR 4 holds the bus master registers in I/O space. */
+  bar = pci_read_config(addr, PCI_REG_BAR0 + 4 * 4);
+  if ((bar & 1) == 0 || (bar & ~3u) == 0)
+    return 0;
+
+  pci_write_config(addr, PCI_REG_COMMAND,
+                   pci_read_config(addr, PCI_REG_COMMAND) | PCI_CMD_IO | PCI_CMD_MASTER);
+  return bar & 0xfffc;
+}
+
+/* Fills in channel C's PRD table with the buffers of the
+   requests in its active command and points the bus master at
+   it. */
+static void load_prdt(struct channel* c) {
+  struct prd* prd = c->prdt;
+  struct list_elem* e;
+
+  for (e = list_begin(&c->active); e != list_end(&c->active); e = list_next(e)) {
+    struct block_request* r = list_entry(e, struct block_request, elem);
+    uint32_t addr = vtop(r->buffer);
+    uint32_t left = r->cnt * BLOCK_SECTOR_SIZE;
+
+    /* Split the buffer at 64 kB boundaries. */
+    while (left > 0) {
+      uint32_t size = 0x10000 - (addr & 0xffff);
+      if (size > left)
+        size = left;
+
+      ASSERT(prd < c->prdt + PGSIZE / sizeof *prd);
+      prd->addr = addr;
+      prd->size = size & 0xffff;
+      prd->flags = 0;
+      prd++;
+
+      addr += size;
+      left -= size;
+    }
+  }
+  prd[-1].flags = PRD_EOT;
+
+  outl(reg_bm_prdt(c), vtop(c->prdt));
+}
+
+/* Ends the DMA command on channel C, whose disk has just
+   interrupted, and completes its requests. */
+static void finish_dma(struct channel* c) {
+  uint8_t bm_status = inb(reg_bm_status(c));
+  uint8_t status;
+
+  outb(reg_bm_command(c), 0);  /* Stop the bus master. */
+  status = inb(reg_status(c)); /* Acknowledge interrupt. */
+  outb(reg_bm_status(c), bm_status | BMS_ERR | BMS_INTR);
+
+  if ((bm_status & BMS_ERR) != 0 || (status & STA_ERR) != 0) {
+    struct block_request* r = list_entry(list_front(&c->active), struct block_request, elem);
+    PANIC("%s: disk %s failed, sector=%" PRDSNu, c->active_disk->name,
+          c->active_write ? "write" : "read", r->sector);
+  }
+  finish_command(c);
+}
 
 /* Selects device D, waiting for it to become ready, and then
-   writes SEC_NO to the disk's sector selection registers.  (We
-   use LBA mode.) */
-static void select_sector(struct ata_disk* d, block_sector_t sec_no) {
+   writes SEC_NO to the disk's sector selection registers and CNT
+   to its sector count register.  (We use LBA mode.)  A count of
+   256 is written as 0, as ATA specifies. */
+static void select_sector(struct ata_disk* d, block_sector_t sec_no, size_t cnt) {
   struct channel* c = d->channel;
 
   ASSERT(sec_no < (1UL << 28));
+  ASSERT(cnt >= 1 && cnt <= BLOCK_MULTIPLE_MAX);
 
   select_device_wait(d);
-  outb(reg_nsect(c), 1);
+  outb(reg_nsect(c), cnt == 256 ? 0 : cnt);
   outb(reg_lbal(c), sec_no);
   outb(reg_lbam(c), sec_no >> 8);
   outb(reg_lbah(c), (sec_no >> 16));
@@ -384,18 +801,20 @@ static void output_sector(struct channel* c, const void* sector) {
 
 /* Low-level ATA primitives. */
 
-/* Wait up to 10 seconds for the controller to become idle, that
-   is, for the BSY and DRQ bits to clear in the status register.
+/* Wait up to 10 milliseconds for the controller to become idle,
+   that is, for the BSY and DRQ bits to clear in the status
+   register.  Busy-waits, so interrupts need not be on.
 
    As a side effect, reading the status register clears any
    pending interrupt. */
 static void wait_until_idle(const struct ata_disk* d) {
   int i;
 
-  for (i = 0; i < 1000; i++) {
+  for (i = 0; i < SPIN_CNT + 1000; i++) {
     if ((inb(reg_status(d->channel)) & (STA_BSY | STA_DRQ)) == 0)
       return;
-    timer_usleep(10);
+    if (i >= SPIN_CNT)
+      timer_udelay(10);
   }
 
   printf("%s: idle timeout\n", d->name);
@@ -409,6 +828,10 @@ static bool wait_while_busy(const struct ata_disk* d) {
   struct channel* c = d->channel;
   int i;
 
+  for (i = 0; i < SPIN_CNT; i++)
+    if (!(inb(reg_alt_status(c)) & STA_BSY))
+      return (inb(reg_alt_status(c)) & STA_DRQ) != 0;
+
   for (i = 0; i < 3000; i++) {
     if (i == 700)
       printf("%s: busy, waiting...", d->name);
@@ -424,6 +847,22 @@ static bool wait_while_busy(const struct ata_disk* d) {
   return false;
 }
 
+/* Busy-waits up to 1 second for channel C to clear BSY and set
+   DRQ, as a disk does when it is ready for the first sector of a
+   write.  Returns true if it did.  Interrupts need not be on. */
+static bool wait_for_drq(struct channel* c) {
+  int i;
+
+  for (i = 0; i < SPIN_CNT + 100000; i++) {
+    uint8_t status = inb(reg_alt_status(c));
+    if ((status & STA_BSY) == 0)
+      return (status & STA_DRQ) != 0;
+    if (i >= SPIN_CNT)
+      timer_udelay(10);
+  }
+  return false;
+}
+
 /* Program D's channel so that D is now the selected disk. */
 static void select_device(const struct ata_disk* d) {
   struct channel* c = d->channel;
@@ -432,15 +871,19 @@ static void select_device(const struct ata_disk* d) {
     dev |= DEV_DEV;
   outb(reg_device(c), dev);
   inb(reg_alt_status(c));
-  timer_nsleep(400);
+  timer_ndelay(400);
+  c->selected_dev_no = d->dev_no;
 }
 
 /* Select disk D in its channel, as select_device(), but wait for
-   the channel to become idle before and after. */
+   the channel to become idle before and after.  Does nothing but
+   wait for idle if D is already selected. */
 static void select_device_wait(const struct ata_disk* d) {
   wait_until_idle(d);
-  select_device(d);
-  wait_until_idle(d);
+  if (d->channel->selected_dev_no != d->dev_no) {
+    select_device(d);
+    wait_until_idle(d);
+  }
 }
 
 /* ATA interrupt handler. */
@@ -449,7 +892,9 @@ static void interrupt_handler(struct intr_frame* f) {
 
   for (c = channels; c < channels + CHANNEL_CNT; c++)
     if (f->vec_no == c->irq) {
-      if (c->expecting_interrupt) {
+      if (c->active_disk != NULL)
+        continue_command(c);
+      else if (c->expecting_interrupt) {
         inb(reg_status(c));           /* Acknowledge interrupt. */
         sema_up(&c->completion_wait); /* Wake up waiter. */
       } else
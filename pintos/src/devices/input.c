@@ -1,13 +1,51 @@
 #include "devices/input.h"
 #include <debug.h>
+#include <stdio.h>
+#include <string.h>
 #include "devices/intq.h"
 #include "devices/serial.h"
+#include "threads/synch.h"
 
 /* Stores keys from the keyboard and serial port. */
 static struct intq buffer;
 
+/* Longest line, including its new-line, that canonical mode
+   will collect.  Further characters are dropped until the line
+   is ended. */
+#define LINE_MAX 256
+
+/* Control characters understood in canonical mode. */
+#define CTRL(C) ((C) - 'A' + 1)
+#define KEY_ERASE '\b'     /* Erase one character. */
+#define KEY_DEL 0x7f       /* Erase one character. */
+#define KEY_KILL CTRL('U') /* Erase the whole line. */
+#define KEY_EOF CTRL('D')  /* End of file. */
+
+/* Line discipline state.  Only one thread reads at a time. */
+static struct lock read_lock;
+static enum input_mode mode;
+static char line[LINE_MAX]; /* Line being edited or handed out. */
+static size_t line_len;     /* Bytes in LINE. */
+static size_t line_ofs;     /* Bytes of LINE already read. */
+static bool after_cr;       /* Was the last key a carriage return? */
+
+static void read_line(void);
+static size_t read_raw(uint8_t*, size_t);
+
 /* Initializes the input buffer. */
-void input_init(void) { intq_init(&buffer); }
+void input_init(void) {
+  intq_init(&buffer);
+  lock_init(&read_lock);
+  mode = INPUT_CANONICAL;
+}
+
+/* Selects the line discipline used by input_read(). */
+void input_set_mode(enum input_mode new_mode) {
+  lock_acquire(&read_lock);
+  mode = new_mode;
+  after_cr = false;
+  lock_release(&read_lock);
+}
 
 /* Adds a key to the input buffer.
    Interrupts must be off and the buffer must not be full. */
@@ -33,6 +71,113 @@ uint8_t input_getc(void) {
   return key;
 }
 
+/* Reads up to SIZE bytes of input into BUFFER and returns the
+   number of bytes read.
+
+   In canonical mode, waits until a whole line has been typed,
+   echoing it and handling backspace and Ctrl+U as it goes, and
+   then returns as much of the line, including its new-line, as
+   fits.  The rest is returned by later calls.  Ctrl+D ends the
+   line without a new-line; at the start of a line it makes this
+   function return 0, for end of file.
+
+   In raw mode, waits for at least one key, then returns every
+   key already buffered, up to SIZE, without interpretation or
+   echo. */
+size_t input_read(void* buffer_, size_t size) {
+  uint8_t* buffer = buffer_;
+  size_t cnt;
+
+  ASSERT(!intr_context());
+
+  if (size == 0)
+    return 0;
+
+  lock_acquire(&read_lock);
+  if (line_ofs < line_len) {
+    /* Finish off a line from an earlier call first. */
+    cnt = line_len - line_ofs < size ? line_len - line_ofs : size;
+    memcpy(buffer, line + line_ofs, cnt);
+    line_ofs += cnt;
+  } else if (mode == INPUT_CANONICAL) {
+    read_line();
+    cnt = line_len < size ? line_len : size;
+    memcpy(buffer, line, cnt);
+    line_ofs = cnt;
+  } else
+    cnt = read_raw(buffer, size);
+  lock_release(&read_lock);
+
+  return cnt;
+}
+
+/* Collects and echoes one edited line into `line'.  A line
+   ends at a carriage return, a new-line, or the two together,
+   so that terminals sending CR LF do not produce an extra empty
+   line. */
+static void read_line(void) {
+  line_len = line_ofs = 0;
+  for (;;) {
+    char c = input_getc();
+    if (c == '\n' && after_cr) {
+      /* Second half of a CR LF pair. */
+      after_cr = false;
+      continue;
+    }
+    after_cr = c == '\r';
+    switch (c) {
+      case '\r':
+      case '\n':
+        line[line_len++] = '\n';
+        putbuf("\n", 1);
+        return;
+
+      case KEY_EOF:
+        return;
+
+      case KEY_ERASE:
+      case KEY_DEL:
+        if (line_len > 0) {
+          line_len--;
+          putbuf("\b \b", 3);
+        }
+        break;
+
+      case KEY_KILL:
+        while (line_len > 0) {
+          line_len--;
+          putbuf("\b \b", 3);
+        }
+        break;
+
+      default:
+        /* Keep room for the new-line. */
+        if (line_len < LINE_MAX - 1) {
+          line[line_len++] = c;
+          putbuf(&c, 1);
+        }
+        break;
+    }
+  }
+}
+
+/* Waits for a key, then moves it and any keys behind it, up to
+   SIZE in all, from the input buffer into DST.  Returns the
+   number of keys moved. */
+static size_t read_raw(uint8_t* dst, size_t size) {
+  enum intr_level old_level;
+  size_t cnt = 0;
+
+  old_level = intr_disable();
+  do
+    dst[cnt++] = intq_getc(&buffer);
+  while (cnt < size && !intq_empty(&buffer));
+  serial_notify();
+  intr_set_level(old_level);
+
+  return cnt;
+}
+
 /* Returns true if the input buffer is full,
    false otherwise.
    Interrupts must be off. */
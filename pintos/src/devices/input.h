@@ -2,11 +2,20 @@
 #define DEVICES_INPUT_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
+/* How input_read() treats keys. */
+enum input_mode {
+  INPUT_CANONICAL, /* Line at a time, with echo and editing. */
+  INPUT_RAW        /* Keys as they arrive, without echo. */
+};
+
 void input_init(void);
+void input_set_mode(enum input_mode);
 void input_putc(uint8_t);
 uint8_t input_getc(void);
+size_t input_read(void*, size_t);
 bool input_full(void);
 
 #endif /* devices/input.h */
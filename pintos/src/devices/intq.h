@@ -18,7 +18,7 @@
    handlers. */
 
 /* Queue buffer size, in bytes. */
-#define INTQ_BUFSIZE 64
+#define INTQ_BUFSIZE 1024
 
 /* A circular queue of bytes. */
 struct intq {
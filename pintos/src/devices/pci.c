@@ -0,0 +1,68 @@
+#include "devices/pci.h"
+#include <debug.h>
+#include "threads/io.h"
+
+/* This code gives access to PCI configuration space through
+   configuration mechanism #1, which every PC since the early
+   PCI days supports.  It only does enough for drivers to find
+   and set up the devices they handle. */
+
+/* Configuration mechanism #1 ports. */
+#define PCI_CONFIG_ADDR 0xcf8 /* Selects a configuration register. */
+#define PCI_CONFIG_DATA 0xcfc /* Accesses the selected register. */
+
+/* Selects configuration register REG, which must be
+   4-byte aligned, of the function at ADDR. */
+static void select_config(struct pci_addr addr, uint8_t reg) {
+  ASSERT(addr.dev < 32 && addr.func < 8);
+  ASSERT(reg % 4 == 0);
+
+  outl(PCI_CONFIG_ADDR, 0x80000000 | (addr.bus << 16) | (addr.dev << 11) | (addr.func << 8) | reg);
+}
+
+/* Returns the 32-bit configuration register REG of the function
+   at ADDR.  Reads all 1-bits if there is no such function. */
+uint32_t pci_read_config(struct pci_addr addr, uint8_t reg) {
+  select_config(addr, reg);
+  return inl(PCI_CONFIG_DATA);
+}
+
+/* Sets configuration register REG of the function at ADDR to
+   VALUE. */
+void pci_write_config(struct pci_addr addr, uint8_t reg, uint32_t value) {
+  select_config(addr, reg);
+  outl(PCI_CONFIG_DATA, value);
+}
+
+/* Searches every PCI bus for a function of the given CLASS and
+   SUBCLASS.  If one is found, stores its location in *ADDR and
+   returns true.  Otherwise, returns false. */
+bool pci_find_class(uint8_t class, uint8_t subclass, struct pci_addr* addr) {
+  int bus, dev, func;
+
+  for (bus = 0; bus < 256; bus++)
+    for (dev = 0; dev < 32; dev++)
+      for (func = 0; func < 8; func++) {
+        struct pci_addr a = {bus, dev, func};
+        uint32_t class_reg;
+
+        if ((pci_read_config(a, PCI_REG_ID) & 0xffff) == 0xffff) {
+          /* No such function.  If function 0 is missing, so is
+             the whole device. */
+          if (func == 0)
+            break;
+          continue;
+        }
+
+        class_reg = pci_read_config(a, PCI_REG_CLASS);
+        if ((class_reg >> 24) == class && ((class_reg >> 16) & 0xff) == subclass) {
+          *addr = a;
+          return true;
+        }
+
+        /* Only multifunction devices have functions past 0. */
+        if (func == 0 && (pci_read_config(a, PCI_REG_HEADER) & 0x800000) == 0)
+          break;
+      }
+  return false;
+}
@@ -0,0 +1,29 @@
+#ifndef DEVICES_PCI_H
+#define DEVICES_PCI_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Location of a PCI function in configuration space. */
+struct pci_addr {
+  uint8_t bus;  /* Bus number, 0...255. */
+  uint8_t dev;  /* Device number, 0...31. */
+  uint8_t func; /* Function number, 0...7. */
+};
+
+/* Offsets of configuration space registers. */
+#define PCI_REG_ID 0x00      /* Vendor ID (low), device ID (high). */
+#define PCI_REG_COMMAND 0x04 /* Command (low), status (high). */
+#define PCI_REG_CLASS 0x08   /* Revision, prog-if, subclass, class. */
+#define PCI_REG_HEADER 0x0c  /* Header type in bits 16...23. */
+#define PCI_REG_BAR0 0x10    /* First of six base address registers. */
+
+/* Command register bits. */
+#define PCI_CMD_IO 0x0001     /* Respond to I/O space accesses. */
+#define PCI_CMD_MASTER 0x0004 /* Allow bus mastering. */
+
+uint32_t pci_read_config(struct pci_addr, uint8_t reg);
+void pci_write_config(struct pci_addr, uint8_t reg, uint32_t value);
+bool pci_find_class(uint8_t class, uint8_t subclass, struct pci_addr*);
+
+#endif /* devices/pci.h */
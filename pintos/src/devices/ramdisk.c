@@ -0,0 +1,114 @@
+#include "devices/ramdisk.h"
+#include <debug.h>
+#include <round.h>
+#include <stdio.h>
+#include <string.h>
+#include "devices/timer.h"
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/vaddr.h"
+
+/* A block device kept in memory.
+
+   Its contents are lost at power off, so it is useful mainly as
+   a fast, deterministic backend for measuring the CPU overhead
+   of the file system or virtual memory code apart from the cost
+   of talking to a disk.  An optional per-request latency lets it
+   stand in for a disk of known speed. */
+
+/* Sectors per page of backing memory. */
+#define SECTORS_PER_PAGE (PGSIZE / BLOCK_SECTOR_SIZE)
+
+/* A RAM disk. */
+struct ramdisk {
+  uint8_t** pages;     /* Backing pages, SECTORS_PER_PAGE sectors each. */
+  unsigned latency_us; /* Delay added to each request, in microseconds. */
+};
+
+static struct block_operations ramdisk_operations;
+
+/* Number of RAM disks created so far, for naming them. */
+static int ramdisk_cnt;
+
+/* Creates a RAM disk of SIZE sectors, zero-filled, and registers
+   it as a block device of type ROLE, named "ram0", "ram1", and
+   so on.  Each request to it takes at least LATENCY_US
+   microseconds.  The memory comes from the kernel pool, one page
+   at a time, so it need not be contiguous.  Panics if there is
+   not enough memory. */
+void ramdisk_create(enum block_type role, block_sector_t size, unsigned latency_us) {
+  size_t page_cnt = DIV_ROUND_UP(size, SECTORS_PER_PAGE);
+  struct ramdisk* rd;
+  char name[16];
+  char extra_info[32];
+  size_t i;
+
+  ASSERT(role < BLOCK_ROLE_CNT);
+  ASSERT(size > 0);
+
+  rd = malloc(sizeof *rd);
+  if (rd != NULL)
+    rd->pages = malloc(page_cnt * sizeof *rd->pages);
+  if (rd == NULL || rd->pages == NULL)
+    PANIC("Failed to allocate memory for RAM disk descriptor");
+  for (i = 0; i < page_cnt; i++) {
+    rd->pages[i] = palloc_get_page(PAL_ZERO);
+    if (rd->pages[i] == NULL)
+      PANIC("Not enough memory for %" PRDSNu "-sector RAM disk", size);
+  }
+  rd->latency_us = latency_us;
+
+  snprintf(name, sizeof name, "ram%d", ramdisk_cnt++);
+  snprintf(extra_info, sizeof extra_info, "latency %u us", latency_us);
+  block_register(name, role, extra_info, size, &ramdisk_operations, rd);
+}
+
+/* Returns the address of SECTOR in RD's memory. */
+static uint8_t* sector_addr(const struct ramdisk* rd, block_sector_t sector) {
+  return rd->pages[sector / SECTORS_PER_PAGE] + sector % SECTORS_PER_PAGE * BLOCK_SECTOR_SIZE;
+}
+
+/* Delays for RD's latency. */
+static void delay(const struct ramdisk* rd) {
+  if (rd->latency_us > 0)
+    timer_usleep(rd->latency_us);
+}
+
+/* Reads CNT sectors starting at SECTOR from RAM disk RD_ into
+   BUFFER. */
+static void ramdisk_read_multiple(void* rd_, block_sector_t sector, size_t cnt, void* buffer_) {
+  struct ramdisk* rd = rd_;
+  uint8_t* buffer = buffer_;
+  size_t i;
+
+  delay(rd);
+  for (i = 0; i < cnt; i++)
+    memcpy(buffer + i * BLOCK_SECTOR_SIZE, sector_addr(rd, sector + i), BLOCK_SECTOR_SIZE);
+}
+
+/* Writes CNT sectors starting at SECTOR to RAM disk RD_ from
+   BUFFER. */
+static void ramdisk_write_multiple(void* rd_, block_sector_t sector, size_t cnt,
+                                   const void* buffer_) {
+  struct ramdisk* rd = rd_;
+  const uint8_t* buffer = buffer_;
+  size_t i;
+
+  delay(rd);
+  for (i = 0; i < cnt; i++)
+    memcpy(sector_addr(rd, sector + i), buffer + i * BLOCK_SECTOR_SIZE, BLOCK_SECTOR_SIZE);
+}
+
+/* Reads sector SECTOR from RAM disk RD into BUFFER. */
+static void ramdisk_read(void* rd, block_sector_t sector, void* buffer) {
+  ramdisk_read_multiple(rd, sector, 1, buffer);
+}
+
+/* Writes sector SECTOR to RAM disk RD from BUFFER. */
+static void ramdisk_write(void* rd, block_sector_t sector, const void* buffer) {
+  ramdisk_write_multiple(rd, sector, 1, buffer);
+}
+
+static struct block_operations ramdisk_operations = {ramdisk_read, ramdisk_write,
+                                                     ramdisk_read_multiple,
+                                                     ramdisk_write_multiple, NULL};
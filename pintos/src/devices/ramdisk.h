@@ -0,0 +1,8 @@
+#ifndef DEVICES_RAMDISK_H
+#define DEVICES_RAMDISK_H
+
+#include "devices/block.h"
+
+void ramdisk_create(enum block_type role, block_sector_t size, unsigned latency_us);
+
+#endif /* devices/ramdisk.h */
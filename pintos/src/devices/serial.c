@@ -1,7 +1,6 @@
 #include "devices/serial.h"
 #include <debug.h>
 #include "devices/input.h"
-#include "devices/intq.h"
 #include "devices/timer.h"
 #include "threads/io.h"
 #include "threads/interrupt.h"
@@ -33,6 +32,17 @@
 #define MCR_REG (IO_BASE + 4) /* MODEM Control Register. */
 #define LSR_REG (IO_BASE + 5) /* Line Status Register (read-only). */
 
+/* Interrupt Identification Register bits. */
+#define IIR_FIFO 0xc0 /* Both set if FIFOs are enabled. */
+
+/* FIFO Control Register bits. */
+#define FCR_ENABLE 0x01   /* Enable FIFOs. */
+#define FCR_CLR_RECV 0x02 /* Clear receive FIFO. */
+#define FCR_CLR_XMIT 0x04 /* Clear transmit FIFO. */
+
+/* Size of the 16550A's transmit FIFO, in bytes. */
+#define XMIT_FIFO_SIZE 16
+
 /* Interrupt Enable Register bits. */
 #define IER_RECV 0x01 /* Interrupt when data received. */
 #define IER_XMIT 0x02 /* Interrupt when transmit finishes. */
@@ -51,9 +61,30 @@
 /* Transmission mode. */
 static enum { UNINIT, POLL, QUEUE } mode;
 
-/* Data to be transmitted. */
-static struct intq txq;
-
+/* Data to be transmitted, in a ring buffer shared with the
+   interrupt handler.  TXQ_HEAD and TXQ_TAIL count bytes ever
+   added and removed, so their difference is the number of bytes
+   queued.  Accessed only with interrupts off. */
+#define TXQ_SIZE 8192 /* Must be a power of 2. */
+static uint8_t txq[TXQ_SIZE];
+static size_t txq_head; /* Bytes ever added. */
+static size_t txq_tail; /* Bytes ever removed. */
+
+/* Threads waiting for room in TXQ, and a semaphore they wait on.
+   The interrupt handler ups it once per waiter whenever it
+   transmits. */
+static int txq_waiters;
+static struct semaphore txq_not_full;
+
+/* Number of bytes that may be written to THR each time it
+   empties: XMIT_FIFO_SIZE if the UART's FIFO works, otherwise
+   1. */
+static int xmit_burst = 1;
+
+static bool txq_empty(void);
+static bool txq_full(void);
+static void txq_putc(uint8_t);
+static uint8_t txq_getc(void);
 static void set_serial(int bps);
 static void putc_poll(uint8_t);
 static void write_ier(void);
@@ -69,7 +100,7 @@ static void init_poll(void) {
   outb(FCR_REG, 0);        /* Disable FIFO. */
   set_serial(9600);        /* 9.6 kbps, N-8-1. */
   outb(MCR_REG, MCR_OUT2); /* Required to enable interrupts. */
-  intq_init(&txq);
+  sema_init(&txq_not_full, 0);
   mode = POLL;
 }
 
@@ -83,6 +114,16 @@ void serial_init_queue(void) {
     init_poll();
   ASSERT(mode == POLL);
 
+  /* Turn on the FIFOs, so that each transmit interrupt can send
+     a burst of bytes.  Older UARTs lack them, which shows in the
+     IIR.  The receive trigger level stays at 1 byte, so input is
+     still delivered at once. */
+  outb(FCR_REG, FCR_ENABLE | FCR_CLR_RECV | FCR_CLR_XMIT);
+  if ((inb(IIR_REG) & IIR_FIFO) == IIR_FIFO)
+    xmit_burst = XMIT_FIFO_SIZE;
+  else
+    outb(FCR_REG, 0);
+
   intr_register_ext(0x20 + 4, serial_interrupt, "serial");
   mode = QUEUE;
   old_level = intr_disable();
@@ -91,28 +132,47 @@ void serial_init_queue(void) {
 }
 
 /* Sends BYTE to the serial port. */
-void serial_putc(uint8_t byte) {
+void serial_putc(uint8_t byte) { serial_write(&byte, 1); }
+
+/* Sends the SIZE bytes in BUFFER to the serial port.  Returns as
+   soon as they are all queued for transmission, which normally
+   requires waiting only if more than the size of the transmit
+   buffer is already queued. */
+void serial_write(const void* buffer_, size_t size) {
+  const uint8_t* buffer = buffer_;
   enum intr_level old_level = intr_disable();
 
   if (mode != QUEUE) {
     /* If we're not set up for interrupt-driven I/O yet,
-         use dumb polling to transmit a byte. */
+         use dumb polling to transmit. */
     if (mode == UNINIT)
       init_poll();
-    putc_poll(byte);
+    while (size-- > 0)
+      putc_poll(*buffer++);
   } else {
-    /* Otherwise, queue a byte and update the interrupt enable
-         register. */
-    if (old_level == INTR_OFF && intq_full(&txq)) {
-      /* Interrupts are off and the transmit queue is full.
-             If we wanted to wait for the queue to empty,
-             we'd have to reenable interrupts.
-             That's impolite, so we'll send a character via
-             polling instead. */
-      putc_poll(intq_getc(&txq));
+    /* Otherwise, queue the bytes and update the interrupt
+       enable register. */
+    while (size > 0) {
+      if (txq_full()) {
+        if (old_level == INTR_ON && !intr_context()) {
+          /* Wait for the interrupt handler to make room. */
+          write_ier();
+          txq_waiters++;
+          sema_down(&txq_not_full);
+          continue;
+        }
+
+        /* Interrupts are off and the transmit queue is full.
+           If we wanted to wait for the queue to empty,
+           we'd have to reenable interrupts.
+           That's impolite, so we'll send a character via
+           polling instead. */
+        putc_poll(txq_getc());
+      }
+
+      txq_putc(*buffer++);
+      size--;
     }
-
-    intq_putc(&txq, byte);
     write_ier();
   }
 
@@ -123,8 +183,8 @@ void serial_putc(uint8_t byte) {
    mode. */
 void serial_flush(void) {
   enum intr_level old_level = intr_disable();
-  while (!intq_empty(&txq))
-    putc_poll(intq_getc(&txq));
+  while (!txq_empty())
+    putc_poll(txq_getc());
   intr_set_level(old_level);
 }
 
@@ -164,7 +224,7 @@ static void write_ier(void) {
 
   /* Enable transmit interrupt if we have any characters to
      transmit. */
-  if (!intq_empty(&txq))
+  if (!txq_empty())
     ier |= IER_XMIT;
 
   /* Enable receive interrupt if we have room to store any
@@ -175,6 +235,31 @@ static void write_ier(void) {
   outb(IER_REG, ier);
 }
 
+/* Returns true if the transmit queue is empty. */
+static bool txq_empty(void) {
+  ASSERT(intr_get_level() == INTR_OFF);
+  return txq_head == txq_tail;
+}
+
+/* Returns true if the transmit queue is full. */
+static bool txq_full(void) {
+  ASSERT(intr_get_level() == INTR_OFF);
+  return txq_head - txq_tail == TXQ_SIZE;
+}
+
+/* Adds BYTE to the transmit queue, which must not be full. */
+static void txq_putc(uint8_t byte) {
+  ASSERT(!txq_full());
+  txq[txq_head++ % TXQ_SIZE] = byte;
+}
+
+/* Removes and returns the oldest byte in the transmit queue,
+   which must not be empty. */
+static uint8_t txq_getc(void) {
+  ASSERT(!txq_empty());
+  return txq[txq_tail++ % TXQ_SIZE];
+}
+
 /* Polls the serial port until it's ready,
    and then transmits BYTE. */
 static void putc_poll(uint8_t byte) {
@@ -196,10 +281,16 @@ static void serial_interrupt(struct intr_frame* f UNUSED) {
   while (!input_full() && (inb(LSR_REG) & LSR_DR) != 0)
     input_putc(inb(RBR_REG));
 
-  /* As long as we have a byte to transmit, and the hardware is
-     ready to accept a byte for transmission, transmit a byte. */
-  while (!intq_empty(&txq) && (inb(LSR_REG) & LSR_THRE) != 0)
-    outb(THR_REG, intq_getc(&txq));
+  /* If the hardware is ready to accept bytes for transmission,
+     which means its FIFO (if any) is empty, fill it. */
+  if ((inb(LSR_REG) & LSR_THRE) != 0) {
+    int i;
+
+    for (i = 0; i < xmit_burst && !txq_empty(); i++)
+      outb(THR_REG, txq_getc());
+    for (; txq_waiters > 0; txq_waiters--)
+      sema_up(&txq_not_full);
+  }
 
   /* Update interrupt enable register based on queue status. */
   write_ier();
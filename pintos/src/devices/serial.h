@@ -1,10 +1,20 @@
 #ifndef DEVICES_SERIAL_H
 #define DEVICES_SERIAL_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 void serial_init_queue(void);
 void serial_putc(uint8_t);
+
+/* Queues bytes for transmission.  This is not a non-blocking
+   write: the console must not lose output, so when the 8 kB
+   transmit ring fills, a caller with interrupts on sleeps until
+   the interrupt handler makes room, and a caller with interrupts
+   off or in an interrupt handler transmits by polling instead.
+   Either way, every byte is queued or sent before returning. */
+void serial_write(const void*, size_t);
+
 void serial_flush(void);
 void serial_notify(void);
 
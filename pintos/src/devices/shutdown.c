@@ -4,6 +4,7 @@
 #include "devices/kbd.h"
 #include "devices/serial.h"
 #include "devices/timer.h"
+#include "devices/vga.h"
 #include "threads/io.h"
 #include "threads/thread.h"
 #ifdef USERPROG
@@ -21,6 +22,7 @@
 static enum shutdown_type how = SHUTDOWN_NONE;
 
 static void print_stats(void);
+static void power_off(void) NO_RETURN;
 
 /* Shuts down the machine in the way configured by
    shutdown_configure().  If the shutdown type is SHUTDOWN_NONE
@@ -71,12 +73,9 @@ void shutdown_reboot(void) {
   }
 }
 
-/* Powers down the machine we're running on,
-   as long as we're running on Bochs or QEMU. */
+/* Writes out file system data, prints statistics, and powers
+   down the machine we're running on. */
 void shutdown_power_off(void) {
-  const char s[] = "Shutdown";
-  const char* p;
-
 #ifdef FILESYS
   filesys_done();
 #endif
@@ -84,7 +83,24 @@ void shutdown_power_off(void) {
   print_stats();
 
   printf("Powering off...\n");
+  power_off();
+}
+
+/* Powers down the machine immediately, without writing unwritten
+   file system data to disk, to simulate a power failure. */
+void shutdown_crash(void) {
+  printf("Simulating power failure...\n");
+  power_off();
+}
+
+/* Powers down the machine we're running on,
+   as long as we're running on Bochs or QEMU. */
+static void power_off(void) {
+  const char s[] = "Shutdown";
+  const char* p;
+
   serial_flush();
+  vga_flush();
 
   /* ACPI power-off */
   outw(0xB004, 0x2000);
@@ -14,5 +14,6 @@ void shutdown(void);
 void shutdown_configure(enum shutdown_type);
 void shutdown_reboot(void) NO_RETURN;
 void shutdown_power_off(void) NO_RETURN;
+void shutdown_crash(void) NO_RETURN;
 
 #endif /* devices/shutdown.h */
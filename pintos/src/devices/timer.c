@@ -4,9 +4,13 @@
 #include <round.h>
 #include <stdio.h>
 #include "devices/pit.h"
+#include "devices/vga.h"
 #include "threads/interrupt.h"
 #include "threads/synch.h"
 #include "threads/thread.h"
+#ifdef USERPROG
+#include "userprog/kdata.h"
+#endif
 
 /* See [8254] for hardware details of the 8254 timer chip. */
 
@@ -24,11 +28,32 @@ static int64_t ticks;
    Initialized by timer_calibrate(). */
 static unsigned loops_per_tick;
 
+/* Timer ticks over which to measure the TSC's frequency. */
+#define TSC_CALIBRATION_TICKS 10
+
+/* Conversion from time stamp counter cycles to nanoseconds, as
+   ns = cycles * tsc_mult >> tsc_shift, with tsc_mult chosen to
+   fit in 32 bits.  tsc_mult is 0 until timer_calibrate() has
+   measured the TSC, or if the CPU has none. */
+static uint32_t tsc_mult;
+static unsigned tsc_shift;
+
+/* TSC reading and time since boot, in nanoseconds, at the end of
+   calibration.  Later times are measured from here. */
+static uint64_t tsc_base;
+static int64_t ns_base;
+
+/* Latest time returned by timer_now_ns(). */
+static int64_t last_ns;
+
 static intr_handler_func timer_interrupt;
 static bool too_many_loops(unsigned loops);
 static void busy_wait(int64_t loops);
 static void real_time_sleep(int64_t num, int32_t denom);
 static void real_time_delay(int64_t num, int32_t denom);
+static bool tsc_present(void);
+static uint64_t rdtsc(void);
+static void calibrate_tsc(void);
 
 /* Sets up the timer to interrupt TIMER_FREQ times per second,
    and registers the corresponding interrupt. */
@@ -37,7 +62,8 @@ void timer_init(void) {
   intr_register_ext(0x20, timer_interrupt, "8254 Timer");
 }
 
-/* Calibrates loops_per_tick, used to implement brief delays. */
+/* Calibrates loops_per_tick, used to implement brief delays,
+   and the time stamp counter used by timer_now_ns(). */
 void timer_calibrate(void) {
   unsigned high_bit, test_bit;
 
@@ -59,6 +85,9 @@ void timer_calibrate(void) {
       loops_per_tick |= test_bit;
 
   printf("%'" PRIu64 " loops/s.\n", (uint64_t)loops_per_tick * TIMER_FREQ);
+
+  if (tsc_present())
+    calibrate_tsc();
 }
 
 /* Returns the number of timer ticks since the OS booted. */
@@ -73,6 +102,32 @@ int64_t timer_ticks(void) {
    should be a value once returned by timer_ticks(). */
 int64_t timer_elapsed(int64_t then) { return timer_ticks() - then; }
 
+/* Returns the number of nanoseconds since the OS booted, read
+   from the time stamp counter.  Until timer_calibrate() has run,
+   or if the CPU has no TSC, the result only advances once per
+   timer tick.  Never returns less than an earlier call did. */
+int64_t timer_now_ns(void) {
+  enum intr_level old_level = intr_disable();
+  int64_t ns;
+
+  if (tsc_mult != 0) {
+    uint64_t cycles = rdtsc() - tsc_base;
+    uint64_t hi = (cycles >> 32) * tsc_mult;
+    uint64_t lo = (cycles & 0xffffffff) * tsc_mult;
+    ns = ns_base + (int64_t)((hi << (32 - tsc_shift)) + (lo >> tsc_shift));
+  } else
+    ns = ticks * (1000 * 1000 * 1000 / TIMER_FREQ);
+
+  /* Rounding in the conversion must not make time run
+     backward across the switch from ticks to the TSC. */
+  if (ns < last_ns)
+    ns = last_ns;
+  last_ns = ns;
+  intr_set_level(old_level);
+
+  return ns;
+}
+
 /* Sleeps for approximately TICKS timer ticks.  Interrupts must
    be turned on. */
 void timer_sleep(int64_t ticks) {
@@ -128,7 +183,11 @@ void timer_print_stats(void) { printf("Timer: %" PRId64 " ticks\n", timer_ticks(
 /* Timer interrupt handler. */
 static void timer_interrupt(struct intr_frame* args UNUSED) {
   ticks++;
+#ifdef USERPROG
+  kdata_tick(ticks);
+#endif
   thread_tick();
+  vga_flush();
 }
 
 /* Returns true if LOOPS iterations waits for more than one timer
@@ -148,6 +207,57 @@ static bool too_many_loops(unsigned loops) {
   return start != ticks;
 }
 
+/* Returns true if the CPU has a time stamp counter, according
+   to CPUID, false otherwise. */
+static bool tsc_present(void) {
+  uint32_t eax = 1, ebx, ecx, edx;
+  asm volatile("cpuid" : "+a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx));
+  return (edx & (1u << 4)) != 0;
+}
+
+/* Returns the time stamp counter. */
+static uint64_t rdtsc(void) {
+  uint64_t tsc;
+  asm volatile("rdtsc" : "=A"(tsc));
+  return tsc;
+}
+
+/* Measures the TSC's frequency against the timer over
+   TSC_CALIBRATION_TICKS ticks and sets up the conversion used by
+   timer_now_ns(). */
+static void calibrate_tsc(void) {
+  enum intr_level old_level;
+  uint64_t start_tsc, end_tsc, freq;
+  int64_t start, end;
+
+  /* Start right after a timer tick. */
+  start = ticks;
+  while (ticks == start)
+    barrier();
+  start_tsc = rdtsc();
+  start = ticks;
+
+  end = start + TSC_CALIBRATION_TICKS;
+  while (ticks != end)
+    barrier();
+  end_tsc = rdtsc();
+
+  freq = (end_tsc - start_tsc) * TIMER_FREQ / TSC_CALIBRATION_TICKS;
+  if (freq == 0)
+    return;
+
+  /* Use the most precise multiplier that fits in 32 bits. */
+  tsc_shift = 32;
+  while (tsc_shift > 0 && (1000000000ull << tsc_shift) / freq > UINT32_MAX)
+    tsc_shift--;
+
+  old_level = intr_disable();
+  tsc_base = end_tsc;
+  ns_base = end * (1000 * 1000 * 1000 / TIMER_FREQ);
+  tsc_mult = (1000000000ull << tsc_shift) / freq;
+  intr_set_level(old_level);
+}
+
 /* Iterates through a simple loop LOOPS times, for implementing
    brief delays.
 
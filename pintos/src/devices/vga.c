@@ -1,4 +1,5 @@
 #include "devices/vga.h"
+#include <debug.h>
 #include <round.h>
 #include <stdint.h>
 #include <stddef.h>
@@ -8,14 +9,23 @@
 #include "threads/interrupt.h"
 #include "threads/vaddr.h"
 
-/* VGA text screen support.  See [FREEVGA] for more information. */
+/* VGA text screen support.  See [FREEVGA] for more information.
+
+   Writing to video memory is slow, especially under an emulator,
+   and so is moving the hardware cursor.  So text is written to
+   a shadow copy of the screen in ordinary memory, and rows that
+   have changed are copied to video memory, and the cursor moved,
+   only by vga_flush(), which is called on each timer tick.
+
+   The shadow rows form a circular array, so that scrolling only
+   advances the index of the top row and clears one row. */
 
 /* Number of columns and rows on the text display. */
 #define COL_CNT 80
 #define ROW_CNT 25
 
 /* Current cursor position.  (0,0) is in the upper left corner of
-   the display. */
+   the display.  The hardware cursor catches up in vga_flush(). */
 static size_t cx, cy;
 
 /* Attribute value for gray text on a black background. */
@@ -26,6 +36,19 @@ static size_t cx, cy;
    The attribute at (x,y) is fb[y][x][1]. */
 static uint8_t (*fb)[COL_CNT][2];
 
+/* Shadow copy of the framebuffer.  Screen row Y is kept in
+   shadow[(top + Y) % ROW_CNT]. */
+static uint8_t shadow[ROW_CNT][COL_CNT][2];
+static size_t top;
+
+/* Bit Y is set if screen row Y differs from video memory. */
+static uint32_t dirty_rows;
+
+/* Position of the hardware cursor. */
+static size_t hw_cx, hw_cy;
+
+static uint8_t (*screen_row(size_t y))[2];
+static void putc_locked(int c, enum intr_level);
 static void clear_row(size_t y);
 static void cls(void);
 static void newline(void);
@@ -38,7 +61,10 @@ static void init(void) {
   static bool inited;
   if (!inited) {
     fb = ptov(0xb8000);
+    memcpy(shadow, fb, sizeof shadow);
     find_cursor(&cx, &cy);
+    hw_cx = cx;
+    hw_cy = cy;
     inited = true;
   }
 }
@@ -51,7 +77,56 @@ void vga_putc(int c) {
   enum intr_level old_level = intr_disable();
 
   init();
+  putc_locked(c, old_level);
+
+  intr_set_level(old_level);
+}
+
+/* Writes the SIZE characters in BUFFER to the VGA text display,
+   as vga_putc() would one at a time, but disabling interrupts
+   only once. */
+void vga_write(const char* buffer, size_t size) {
+  enum intr_level old_level = intr_disable();
+
+  init();
+  while (size-- > 0)
+    putc_locked(*buffer++, old_level);
+
+  intr_set_level(old_level);
+}
 
+/* Copies the rows of the display that have changed since the
+   last call to video memory, and moves the hardware cursor to
+   its current position.  May be called from an interrupt
+   handler. */
+void vga_flush(void) {
+  enum intr_level old_level = intr_disable();
+
+  init();
+  if (dirty_rows != 0) {
+    size_t y;
+
+    for (y = 0; y < ROW_CNT; y++)
+      if (dirty_rows & (1u << y))
+        memcpy(fb[y], screen_row(y), sizeof fb[y]);
+    dirty_rows = 0;
+  }
+  if (cx != hw_cx || cy != hw_cy)
+    move_cursor();
+
+  intr_set_level(old_level);
+}
+
+/* Returns the shadow copy of screen row Y. */
+static uint8_t (*screen_row(size_t y))[2] {
+  ASSERT(y < ROW_CNT);
+  return shadow[(top + y) % ROW_CNT];
+}
+
+/* Writes C to the VGA text display.  Interrupts must be off;
+   OLD_LEVEL is the level they will be restored to, which is used
+   while beeping. */
+static void putc_locked(int c, enum intr_level old_level) {
   switch (c) {
     case '\n':
       newline();
@@ -83,17 +158,13 @@ void vga_putc(int c) {
       break;
 
     default:
-      fb[cy][cx][0] = c;
-      fb[cy][cx][1] = GRAY_ON_BLACK;
+      screen_row(cy)[cx][0] = c;
+      screen_row(cy)[cx][1] = GRAY_ON_BLACK;
+      dirty_rows |= 1u << cy;
       if (++cx >= COL_CNT)
         newline();
       break;
   }
-
-  /* Update cursor position. */
-  move_cursor();
-
-  intr_set_level(old_level);
 }
 
 /* Clears the screen and moves the cursor to the upper left. */
@@ -104,17 +175,18 @@ static void cls(void) {
     clear_row(y);
 
   cx = cy = 0;
-  move_cursor();
 }
 
-/* Clears row Y to spaces. */
+/* Clears screen row Y to spaces. */
 static void clear_row(size_t y) {
+  uint8_t(*row)[2] = screen_row(y);
   size_t x;
 
   for (x = 0; x < COL_CNT; x++) {
-    fb[y][x][0] = ' ';
-    fb[y][x][1] = GRAY_ON_BLACK;
+    row[x][0] = ' ';
+    row[x][1] = GRAY_ON_BLACK;
   }
+  dirty_rows |= 1u << y;
 }
 
 /* Advances the cursor to the first column in the next line on
@@ -124,9 +196,12 @@ static void newline(void) {
   cx = 0;
   cy++;
   if (cy >= ROW_CNT) {
+    /* The old top row becomes the new bottom row.  Every row
+       moves up on the screen, so all of them are dirty. */
     cy = ROW_CNT - 1;
-    memmove(&fb[0], &fb[1], sizeof fb[0] * (ROW_CNT - 1));
+    top = (top + 1) % ROW_CNT;
     clear_row(ROW_CNT - 1);
+    dirty_rows = (1u << ROW_CNT) - 1;
   }
 }
 
@@ -136,6 +211,8 @@ static void move_cursor(void) {
   uint16_t cp = cx + COL_CNT * cy;
   outw(0x3d4, 0x0e | (cp & 0xff00));
   outw(0x3d4, 0x0f | (cp << 8));
+  hw_cx = cx;
+  hw_cy = cy;
 }
 
 /* Reads the current hardware cursor position into (*X,*Y). */
@@ -1,14 +1,19 @@
 /* cat.c
 
-   Prints files specified on command line to the console. */
+   Prints files specified on command line to the console, or the
+   console's own input if no files are specified. */
 
 #include <stdio.h>
 #include <syscall.h>
 
+static void copy(int fd);
+
 int main(int argc, char* argv[]) {
   bool success = true;
   int i;
 
+  if (argc < 2)
+    copy(STDIN_FILENO);
   for (i = 1; i < argc; i++) {
     int fd = open(argv[i]);
     if (fd < 0) {
@@ -16,14 +21,19 @@ int main(int argc, char* argv[]) {
       success = false;
       continue;
     }
-    for (;;) {
-      char buffer[1024];
-      int bytes_read = read(fd, buffer, sizeof buffer);
-      if (bytes_read == 0)
-        break;
-      write(STDOUT_FILENO, buffer, bytes_read);
-    }
+    copy(fd);
     close(fd);
   }
   return success ? EXIT_SUCCESS : EXIT_FAILURE;
 }
+
+/* Copies FD to the console until end of file. */
+static void copy(int fd) {
+  for (;;) {
+    char buffer[1024];
+    int bytes_read = read(fd, buffer, sizeof buffer);
+    if (bytes_read <= 0)
+      break;
+    write(STDOUT_FILENO, buffer, bytes_read);
+  }
+}
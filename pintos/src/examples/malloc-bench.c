@@ -0,0 +1,73 @@
+/* malloc-bench.c
+
+   Benchmarks the user-space malloc() and free().
+
+   For each of several block sizes, first allocates blocks and
+   frees each one at once, then allocates a batch of blocks and
+   frees them in random order.  Prints the average time per
+   malloc()/free() pair and how far the heap grew.  An optional
+   argument sets the number of blocks in a batch. */
+
+#include <random.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <syscall.h>
+
+/* Default and largest number of blocks in a batch. */
+#define DEFAULT_CNT 256
+#define MAX_CNT 1024
+
+/* Number of malloc()/free() pairs in the first test. */
+#define PAIR_CNT 10000
+
+static void* blocks[MAX_CNT];
+
+/* Returns nanoseconds per operation, for CNT operations that
+   started at time START. */
+static int ns_per_op(int64_t start, int cnt) { return (clock_ns() - start) / cnt; }
+
+int main(int argc, char* argv[]) {
+  static const size_t sizes[] = {16, 100, 1000, 5000};
+  char* heap_start = sbrk(0);
+  int cnt = argc > 1 ? atoi(argv[1]) : DEFAULT_CNT;
+  size_t s;
+
+  if (cnt < 1 || cnt > MAX_CNT) {
+    printf("malloc-bench: batch size must be between 1 and %d\n", MAX_CNT);
+    return EXIT_FAILURE;
+  }
+
+  printf("%6s %12s %12s %10s\n", "size", "pair (ns)", "batch (ns)", "heap (kB)");
+  for (s = 0; s < sizeof sizes / sizeof *sizes; s++) {
+    size_t size = sizes[s];
+    int64_t start;
+    int pair_ns, batch_ns;
+    int i;
+
+    /* Allocate and free at once. */
+    start = clock_ns();
+    for (i = 0; i < PAIR_CNT; i++)
+      free(malloc(size));
+    pair_ns = ns_per_op(start, PAIR_CNT);
+
+    /* Allocate a batch, then free it in random order. */
+    start = clock_ns();
+    for (i = 0; i < cnt; i++)
+      if ((blocks[i] = malloc(size)) == NULL) {
+        printf("malloc-bench: out of memory after %d blocks of %zu bytes\n", i, size);
+        return EXIT_FAILURE;
+      }
+    for (i = 0; i < cnt; i++) {
+      int j = i + random_ulong() % (cnt - i);
+      void* t = blocks[i];
+      blocks[i] = blocks[j];
+      blocks[j] = t;
+      free(blocks[i]);
+    }
+    batch_ns = ns_per_op(start, cnt);
+
+    printf("%6zu %12d %12d %10d\n", size, pair_ns, batch_ns,
+           (int)((char*)sbrk(0) - heap_start) / 1024);
+  }
+  return EXIT_SUCCESS;
+}
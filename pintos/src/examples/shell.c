@@ -3,8 +3,7 @@
 #include <string.h>
 #include <syscall.h>
 
-static void read_line(char line[], size_t);
-static bool backspace(char** pos, char line[]);
+static bool read_line(char line[], size_t);
 
 int main(void) {
   printf("Shell starting...\n");
@@ -13,7 +12,8 @@ int main(void) {
 
     /* Read command. */
     printf("--");
-    read_line(command, sizeof command);
+    if (!read_line(command, sizeof command))
+      break;
 
     /* Execute command. */
     if (!strcmp(command, "exit"))
@@ -37,51 +37,36 @@ int main(void) {
 }
 
 /* Reads a line of input from the user into LINE, which has room
-   for SIZE bytes.  Handles backspace and Ctrl+U in the ways
-   expected by Unix users.  On return, LINE will always be
-   null-terminated and will not end in a new-line character. */
-static void read_line(char line[], size_t size) {
-  char* pos = line;
+   for SIZE bytes.  The console's line discipline handles echo,
+   backspace, and Ctrl+U, so a line normally arrives in a single
+   read.  On return, LINE will always be null-terminated and will
+   not end in a new-line character.  Returns false at end of
+   input, true otherwise. */
+static bool read_line(char line[], size_t size) {
+  size_t len = 0;
   for (;;) {
-    char c;
-    read(STDIN_FILENO, &c, 1);
-
-    switch (c) {
-      case '\r':
-        *pos = '\0';
-        putchar('\n');
-        return;
-
-      case '\b':
-        backspace(&pos, line);
-        break;
+    char discard[64];
+    int cnt;
 
-      case ('U' - 'A') + 1: /* Ctrl+U. */
-        while (backspace(&pos, line))
-          continue;
-        break;
+    /* Once LINE is full, throw away the rest of the line. */
+    if (len < size - 1)
+      cnt = read(STDIN_FILENO, line + len, size - 1 - len);
+    else
+      cnt = read(STDIN_FILENO, discard, sizeof discard);
+    if (cnt <= 0) {
+      line[len] = '\0';
+      return len > 0;
+    }
 
-      default:
-        /* Add character to line. */
-        if (pos < line + size - 1) {
-          putchar(c);
-          *pos++ = c;
-        }
-        break;
+    if (len < size - 1) {
+      len += cnt;
+      if (line[len - 1] == '\n') {
+        line[len - 1] = '\0';
+        return true;
+      }
+    } else if (discard[cnt - 1] == '\n') {
+      line[len] = '\0';
+      return true;
     }
   }
 }
-
-/* If *POS is past the beginning of LINE, backs up one character
-   position.  Returns true if successful, false if nothing was
-   done. */
-static bool backspace(char** pos, char line[]) {
-  if (*pos > line) {
-    /* Back up cursor, overwrite character, back up
-         again. */
-    printf("\b \b");
-    (*pos)--;
-    return true;
-  } else
-    return false;
-}
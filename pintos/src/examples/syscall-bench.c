@@ -0,0 +1,87 @@
+/* syscall-bench.c
+
+   Measures the round trip cost of the practice() system call,
+   in CPU cycles, through `int $0x30' and through SYSENTER.
+   Prints the average over a number of calls, which an optional
+   argument sets, and the cost of the same loop without a system
+   call for comparison.
+
+   The SYSENTER path runs last because it kills the process on a
+   CPU without SYSENTER, whose kernel leaves it unconfigured. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <syscall.h>
+#include <syscall-nr.h>
+
+/* Default number of calls. */
+#define DEFAULT_CNT 100000
+
+/* Returns the time stamp counter. */
+static inline uint64_t rdtsc(void) {
+  uint64_t tsc;
+  asm volatile("rdtsc" : "=A"(tsc));
+  return tsc;
+}
+
+/* Calls practice(I) through `int $0x30'. */
+static inline int practice_int(int i) {
+  int retval;
+  asm volatile("pushl %[arg0]; pushl %[number]; int $0x30; addl $8, %%esp"
+               : "=a"(retval)
+               : [number] "i"(SYS_PRACTICE), [arg0] "r"(i)
+               : "memory");
+  return retval;
+}
+
+/* Calls practice(I) through SYSENTER. */
+static inline int practice_sysenter(int i) {
+  int retval;
+  asm volatile("pushl %[arg0]; pushl %[number]; "
+               "movl %%esp, %%ecx; movl $1f, %%edx; sysenter; 1: addl $8, %%esp"
+               : "=a"(retval)
+               : [number] "i"(SYS_PRACTICE), [arg0] "r"(i)
+               : "memory", "ecx", "edx");
+  return retval;
+}
+
+/* Returns the average number of cycles per iteration for CNT
+   iterations that started at time START. */
+static unsigned cycles_per_call(uint64_t start, int cnt) {
+  return (unsigned)((rdtsc() - start) / (unsigned)cnt);
+}
+
+int main(int argc, char* argv[]) {
+  int cnt = argc > 1 ? atoi(argv[1]) : DEFAULT_CNT;
+  uint64_t start;
+  int i;
+
+  if (cnt < 1) {
+    printf("syscall-bench: call count must be positive\n");
+    return EXIT_FAILURE;
+  }
+
+  printf("%d calls, cycles per practice() round trip:\n", cnt);
+
+  start = rdtsc();
+  for (i = 0; i < cnt; i++)
+    asm volatile("" : : : "memory");
+  printf("%-10s %8u\n", "loop", cycles_per_call(start, cnt));
+
+  start = rdtsc();
+  for (i = 0; i < cnt; i++)
+    if (practice_int(i) != i + 1) {
+      printf("syscall-bench: practice(%d) failed through int $0x30\n", i);
+      return EXIT_FAILURE;
+    }
+  printf("%-10s %8u\n", "int $0x30", cycles_per_call(start, cnt));
+
+  start = rdtsc();
+  for (i = 0; i < cnt; i++)
+    if (practice_sysenter(i) != i + 1) {
+      printf("syscall-bench: practice(%d) failed through sysenter\n", i);
+      return EXIT_FAILURE;
+    }
+  printf("%-10s %8u\n", "sysenter", cycles_per_call(start, cnt));
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,204 @@
+#include "filesys/dcache.h"
+#include <debug.h>
+#include <hash.h>
+#include <list.h>
+#include <ohash.h>
+#include <string.h>
+#include "filesys/directory.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+
+/* Directory entry (dentry) cache.
+
+   Maps a (directory inumber, name) pair to the inumber that the
+   name refers to in that directory, so that resolving the same
+   path components over and over does not require rereading
+   each directory's contents.  Names that are known not to exist
+   are cached too, as negative entries.
+
+   The directory code keeps the cache coherent: dir_add() and
+   dir_remove() record the new state of a name, and
+   dir_create() purges anything left over from an earlier
+   directory that occupied the same sector.
+
+   After a miss, dir_lookup() reads the directory and caches what
+   it found with dcache_fill().  Nothing is locked in between, so
+   dir_add() or dir_remove() may change the name meanwhile and
+   what dir_lookup() read may already be stale.  To catch this,
+   every change to the cache's contents other than a fill bumps a
+   generation number, which dcache_lookup() reports on a miss,
+   and dcache_fill() caches nothing if the generation has moved
+   on since then. */
+
+/* Maximum number of cached entries.  Beyond this the least
+   recently used entry is evicted. */
+#define DCACHE_MAX 256
+
+/* A cached name. */
+struct dentry {
+  struct ohash_elem hash_elem; /* Element in `dentries'. */
+  struct list_elem lru_elem;   /* Element in `lru'. */
+  block_sector_t dir;          /* Inumber of containing directory. */
+  char name[NAME_MAX + 1];     /* Null terminated file name. */
+  bool present;                /* False for a negative entry. */
+  block_sector_t sector;       /* Inumber of NAME, if PRESENT. */
+};
+
+static struct ohash dentries; /* All cached entries. */
+static struct list lru;       /* Entries, most recently used first. */
+static struct lock dcache_lock;
+static unsigned generation;   /* Changes other than fills. */
+
+static ohash_hash_func dentry_hash;
+static ohash_equal_func dentry_equal;
+static struct dentry* find_dentry(block_sector_t dir, const char* name);
+static void update(block_sector_t dir, const char* name, bool present, block_sector_t sector);
+static void store(block_sector_t dir, const char* name, bool present, block_sector_t sector);
+static void discard(struct dentry*);
+
+/* Initializes the dentry cache. */
+void dcache_init(void) {
+  if (!ohash_init(&dentries, dentry_hash, dentry_equal, NULL))
+    PANIC("dentry cache creation failed");
+  list_init(&lru);
+  lock_init(&dcache_lock);
+}
+
+/* Looks up NAME in directory DIR.  Returns DCACHE_FOUND and sets
+   *SECTORP to the inumber for NAME if NAME is cached as present,
+   DCACHE_ABSENT if it is cached as not existing, or DCACHE_MISS
+   if nothing is cached for it.  On a miss, also sets *GENP to
+   the generation to pass to dcache_fill(). */
+enum dcache_status dcache_lookup(block_sector_t dir, const char* name, block_sector_t* sectorp,
+                                 unsigned* genp) {
+  enum dcache_status status = DCACHE_MISS;
+  struct dentry* d;
+
+  lock_acquire(&dcache_lock);
+  d = find_dentry(dir, name);
+  if (d != NULL) {
+    list_remove(&d->lru_elem);
+    list_push_front(&lru, &d->lru_elem);
+    if (d->present) {
+      *sectorp = d->sector;
+      status = DCACHE_FOUND;
+    } else
+      status = DCACHE_ABSENT;
+  } else
+    *genp = generation;
+  lock_release(&dcache_lock);
+  return status;
+}
+
+/* Records that NAME in directory DIR refers to inumber SECTOR. */
+void dcache_add(block_sector_t dir, const char* name, block_sector_t sector) {
+  update(dir, name, true, sector);
+}
+
+/* Records that there is no NAME in directory DIR. */
+void dcache_add_absent(block_sector_t dir, const char* name) { update(dir, name, false, 0); }
+
+/* Caches what a directory read after a miss found for NAME in
+   DIR: that it refers to inumber SECTOR if PRESENT, otherwise
+   that it does not exist.  Does nothing if the cache has changed
+   since the miss, reported by dcache_lookup() as generation
+   GEN, because the directory read may then be out of date. */
+void dcache_fill(block_sector_t dir, const char* name, bool present, block_sector_t sector,
+                 unsigned gen) {
+  lock_acquire(&dcache_lock);
+  if (gen == generation)
+    store(dir, name, present, sector);
+  lock_release(&dcache_lock);
+}
+
+/* Forgets every entry for a name within directory DIR.  Used when
+   DIR's sector is reused for a new directory. */
+void dcache_purge_dir(block_sector_t dir) {
+  struct list_elem* e;
+
+  lock_acquire(&dcache_lock);
+  generation++;
+  for (e = list_begin(&lru); e != list_end(&lru);) {
+    struct dentry* d = list_entry(e, struct dentry, lru_elem);
+    e = list_next(e);
+    if (d->dir == dir)
+      discard(d);
+  }
+  lock_release(&dcache_lock);
+}
+
+/* Records a change to NAME in DIR, which is now PRESENT and
+   refers to SECTOR, or is absent. */
+static void update(block_sector_t dir, const char* name, bool present, block_sector_t sector) {
+  lock_acquire(&dcache_lock);
+  generation++;
+  store(dir, name, present, sector);
+  lock_release(&dcache_lock);
+}
+
+/* Caches NAME in DIR as PRESENT, referring to SECTOR, replacing
+   any existing entry for it.  Caching is best-effort, so memory
+   allocation failure is silently ignored.  Must be called with
+   dcache_lock held. */
+static void store(block_sector_t dir, const char* name, bool present, block_sector_t sector) {
+  struct dentry* d;
+
+  ASSERT(lock_held_by_current_thread(&dcache_lock));
+  if (strlen(name) > NAME_MAX)
+    return;
+
+  d = find_dentry(dir, name);
+  if (d != NULL)
+    list_remove(&d->lru_elem);
+  else {
+    if (ohash_size(&dentries) >= DCACHE_MAX)
+      discard(list_entry(list_back(&lru), struct dentry, lru_elem));
+    d = malloc(sizeof *d);
+    if (d == NULL)
+      return;
+    d->dir = dir;
+    strlcpy(d->name, name, sizeof d->name);
+    ohash_insert(&dentries, &d->hash_elem);
+  }
+  d->present = present;
+  d->sector = sector;
+  list_push_front(&lru, &d->lru_elem);
+}
+
+/* Returns the entry for NAME in DIR, or a null pointer if there
+   is none.  Must be called with dcache_lock held. */
+static struct dentry* find_dentry(block_sector_t dir, const char* name) {
+  /* Search key.  Kept static, under dcache_lock, to keep it off
+     the kernel stack. */
+  static struct dentry key;
+  struct ohash_elem* e;
+
+  ASSERT(lock_held_by_current_thread(&dcache_lock));
+  key.dir = dir;
+  strlcpy(key.name, name, sizeof key.name);
+  e = ohash_find(&dentries, &key.hash_elem);
+  return e != NULL ? ohash_entry(e, struct dentry, hash_elem) : NULL;
+}
+
+/* Removes D from the cache and frees it.  Must be called with
+   dcache_lock held. */
+static void discard(struct dentry* d) {
+  ohash_delete(&dentries, &d->hash_elem);
+  list_remove(&d->lru_elem);
+  free(d);
+}
+
+/* Returns a hash value for the dentry containing E. */
+static unsigned dentry_hash(const struct ohash_elem* e, void* aux UNUSED) {
+  const struct dentry* d = ohash_entry(e, struct dentry, hash_elem);
+  return hash_string(d->name) ^ hash_int(d->dir);
+}
+
+/* Returns true if the dentries containing A and B are for the
+   same name in the same directory. */
+static bool dentry_equal(const struct ohash_elem* a_, const struct ohash_elem* b_,
+                         void* aux UNUSED) {
+  const struct dentry* a = ohash_entry(a_, struct dentry, hash_elem);
+  const struct dentry* b = ohash_entry(b_, struct dentry, hash_elem);
+  return a->dir == b->dir && !strcmp(a->name, b->name);
+}
@@ -0,0 +1,23 @@
+#ifndef FILESYS_DCACHE_H
+#define FILESYS_DCACHE_H
+
+#include <stdbool.h>
+#include "devices/block.h"
+
+/* Result of a name lookup in the dentry cache. */
+enum dcache_status {
+  DCACHE_MISS,   /* Nothing is known about the name. */
+  DCACHE_FOUND,  /* The name exists. */
+  DCACHE_ABSENT  /* The name is known not to exist. */
+};
+
+void dcache_init(void);
+enum dcache_status dcache_lookup(block_sector_t dir, const char* name, block_sector_t* sectorp,
+                                 unsigned* genp);
+void dcache_add(block_sector_t dir, const char* name, block_sector_t sector);
+void dcache_add_absent(block_sector_t dir, const char* name);
+void dcache_fill(block_sector_t dir, const char* name, bool present, block_sector_t sector,
+                 unsigned gen);
+void dcache_purge_dir(block_sector_t dir);
+
+#endif /* filesys/dcache.h */
@@ -2,6 +2,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <list.h>
+#include "filesys/dcache.h"
 #include "filesys/filesys.h"
 #include "filesys/inode.h"
 #include "threads/malloc.h"
@@ -19,10 +20,49 @@ struct dir_entry {
   bool in_use;                 /* In use or free? */
 };
 
+/* Directory formats.
+
+   A directory is an array of `struct dir_entry' slots.  In the
+   original, linear format (no INODE_DIR_HASHED bit on the
+   directory's inode) an entry may occupy any slot, so finding a
+   name or a free slot means scanning the whole array.
+
+   In the hashed format, an entry for NAME lives in slot
+   name_hash(NAME) % SLOT_CNT or, if that slot was taken, in one
+   of the slots that follow it, wrapping around at the end
+   (linear probing).  A free slot whose name is empty has never
+   been used and ends every probe sequence that reaches it; a
+   free slot that still holds a name is a tombstone left by
+   dir_remove(), which probes step over and dir_add() reuses.
+
+   Either way every slot is a valid `struct dir_entry', so code
+   that just scans for entries with IN_USE set, such as
+   dir_readdir(), reads both formats alike. */
+
+static bool lookup(const struct dir*, const char* name, struct dir_entry*, off_t*);
+static bool find_free_slot(const struct dir*, const char* name, off_t*);
+static void clear_tombstones(struct dir*, off_t ofs);
+
 /* Creates a directory with space for ENTRY_CNT entries in the
-   given SECTOR.  Returns true if successful, false on failure. */
-bool dir_create(block_sector_t sector, size_t entry_cnt) {
-  return inode_create(sector, entry_cnt * sizeof(struct dir_entry));
+   given SECTOR, whose parent is the directory in sector PARENT.
+   One of the entries is used for "..", which refers to PARENT.
+   Returns true if successful, false on failure. */
+bool dir_create(block_sector_t sector, size_t entry_cnt, block_sector_t parent) {
+  struct dir* dir;
+  bool success;
+
+  if (!inode_create(sector, (entry_cnt + 1) * sizeof(struct dir_entry),
+                    INODE_DIR | INODE_DIR_HASHED))
+    return false;
+
+  /* Anything cached under SECTOR belongs to whatever used to live
+     there. */
+  dcache_purge_dir(sector);
+
+  dir = dir_open(inode_open(sector));
+  success = dir != NULL && dir_add(dir, "..", parent);
+  dir_close(dir);
+  return success;
 }
 
 /* Opens and returns the directory for the given INODE, of which
@@ -65,6 +105,42 @@ struct inode* dir_get_inode(struct dir* dir) {
   return dir->inode;
 }
 
+/* Returns true if DIR uses the hashed directory format. */
+static bool is_hashed(const struct dir* dir) {
+  return (inode_get_flags(dir->inode) & INODE_DIR_HASHED) != 0;
+}
+
+/* Returns the number of entry slots in DIR. */
+static size_t slot_cnt(const struct dir* dir) {
+  return inode_length(dir->inode) / sizeof(struct dir_entry);
+}
+
+/* Returns the hash of NAME that determines where its entry goes
+   in a hashed directory (32-bit FNV-1a).  This is part of the
+   on-disk format, so unlike the hash functions in
+   lib/kernel/hash.c it must never change. */
+static uint32_t name_hash(const char* name) {
+  const unsigned char* s = (const unsigned char*)name;
+  uint32_t hash = 2166136261u;
+
+  while (*s != '\0')
+    hash = (hash ^ *s++) * 16777619u;
+  return hash;
+}
+
+/* Returns the byte offset of the slot where the probe sequence
+   for NAME in hashed directory DIR starts. */
+static off_t first_probe(const struct dir* dir, const char* name) {
+  return name_hash(name) % slot_cnt(dir) * sizeof(struct dir_entry);
+}
+
+/* Returns the byte offset of the slot after the one at OFS in
+   hashed directory DIR, wrapping around at the end. */
+static off_t next_probe(const struct dir* dir, off_t ofs) {
+  ofs += sizeof(struct dir_entry);
+  return ofs < (off_t)(slot_cnt(dir) * sizeof(struct dir_entry)) ? ofs : 0;
+}
+
 /* Searches DIR for a file with the given NAME.
    If successful, returns true, sets *EP to the directory entry
    if EP is non-null, and sets *OFSP to the byte offset of the
@@ -77,6 +153,26 @@ static bool lookup(const struct dir* dir, const char* name, struct dir_entry* ep
   ASSERT(dir != NULL);
   ASSERT(name != NULL);
 
+  if (is_hashed(dir)) {
+    size_t cnt = slot_cnt(dir);
+    size_t i;
+
+    ofs = cnt > 0 ? first_probe(dir, name) : 0;
+    for (i = 0; i < cnt; i++, ofs = next_probe(dir, ofs)) {
+      if (inode_read_at(dir->inode, &e, sizeof e, ofs) != sizeof e)
+        break;
+      if (e.in_use && !strcmp(name, e.name)) {
+        if (ep != NULL)
+          *ep = e;
+        if (ofsp != NULL)
+          *ofsp = ofs;
+        return true;
+      } else if (!e.in_use && e.name[0] == '\0')
+        break;
+    }
+    return false;
+  }
+
   for (ofs = 0; inode_read_at(dir->inode, &e, sizeof e, ofs) == sizeof e; ofs += sizeof e)
     if (e.in_use && !strcmp(name, e.name)) {
       if (ep != NULL)
@@ -88,20 +184,104 @@ static bool lookup(const struct dir* dir, const char* name, struct dir_entry* ep
   return false;
 }
 
+/* Finds the slot in hashed directory DIR where an entry for NAME,
+   which must not already be in DIR, should go: the first free
+   slot, tombstone or never used, on NAME's probe sequence.  On
+   success, stores its byte offset in *OFSP and returns true.
+   Returns false if DIR is full. */
+static bool find_free_slot(const struct dir* dir, const char* name, off_t* ofsp) {
+  size_t cnt = slot_cnt(dir);
+  struct dir_entry e;
+  off_t ofs;
+  size_t i;
+
+  if (cnt == 0)
+    return false;
+  ofs = first_probe(dir, name);
+  for (i = 0; i < cnt; i++, ofs = next_probe(dir, ofs)) {
+    if (inode_read_at(dir->inode, &e, sizeof e, ofs) != sizeof e)
+      return false;
+    if (!e.in_use) {
+      *ofsp = ofs;
+      return true;
+    }
+  }
+  return false;
+}
+
+/* Maximum number of tombstones that clear_tombstones() returns
+   to the never-used state at once.  A run of this many entries
+   spans at most two sectors, or four if it wraps around, which
+   keeps a removal within its journal reserve (see
+   JOURNAL_RESERVE in filesys/journal.c) however long the run of
+   tombstones is. */
+#define CLEAR_MAX (BLOCK_SECTOR_SIZE / sizeof(struct dir_entry))
+
+/* Called after the entry at OFS in hashed directory DIR becomes
+   a tombstone.  If the following slot has never been used, no
+   probe sequence passes through OFS any longer, so it and up to
+   CLEAR_MAX - 1 tombstones immediately before it are returned to
+   the never-used state, keeping later probes short.  Any
+   tombstones beyond those stay behind, which makes some probes
+   longer but is otherwise harmless. */
+static void clear_tombstones(struct dir* dir, off_t ofs) {
+  size_t cnt = slot_cnt(dir) < CLEAR_MAX ? slot_cnt(dir) : CLEAR_MAX;
+  struct dir_entry e;
+  size_t i;
+
+  if (inode_read_at(dir->inode, &e, sizeof e, next_probe(dir, ofs)) != sizeof e ||
+      e.in_use || e.name[0] != '\0')
+    return;
+
+  for (i = 0; i < cnt; i++) {
+    if (inode_read_at(dir->inode, &e, sizeof e, ofs) != sizeof e || e.in_use ||
+        e.name[0] == '\0')
+      break;
+    memset(&e, 0, sizeof e);
+    if (inode_write_at(dir->inode, &e, sizeof e, ofs) != sizeof e)
+      break;
+    ofs = (ofs > 0 ? ofs - (off_t)sizeof e
+           : (off_t)((slot_cnt(dir) - 1) * sizeof e));
+  }
+}
+
 /* Searches DIR for a file with the given NAME
    and returns true if one exists, false otherwise.
    On success, sets *INODE to an inode for the file, otherwise to
-   a null pointer.  The caller must close *INODE. */
+   a null pointer.  The caller must close *INODE.
+   NAME may be "." to refer to DIR itself.  Nothing can be found
+   in a directory that has been removed. */
 bool dir_lookup(const struct dir* dir, const char* name, struct inode** inode) {
+  block_sector_t dir_sector;
+  block_sector_t sector;
   struct dir_entry e;
+  unsigned gen;
 
   ASSERT(dir != NULL);
   ASSERT(name != NULL);
 
-  if (lookup(dir, name, &e, NULL))
-    *inode = inode_open(e.inode_sector);
-  else
-    *inode = NULL;
+  *inode = NULL;
+  if (inode_is_removed(dir->inode))
+    return false;
+  if (!strcmp(name, "."))
+    *inode = inode_reopen(dir->inode);
+  else {
+    dir_sector = inode_get_inumber(dir->inode);
+    switch (dcache_lookup(dir_sector, name, &sector, &gen)) {
+      case DCACHE_FOUND:
+        *inode = inode_open(sector);
+        break;
+      case DCACHE_ABSENT:
+        break;
+      case DCACHE_MISS:
+        if (lookup(dir, name, &e, NULL)) {
+          dcache_fill(dir_sector, name, true, e.inode_sector, gen);
+          *inode = inode_open(e.inode_sector);
+        } else
+          dcache_fill(dir_sector, name, false, 0, gen);
+        break;
+    }
+  }
 
   return *inode != NULL;
 }
@@ -121,7 +301,9 @@ bool dir_add(struct dir* dir, const char* name, block_sector_t inode_sector) {
   ASSERT(name != NULL);
 
   /* Check NAME for validity. */
-  if (*name == '\0' || strlen(name) > NAME_MAX)
+  if (*name == '\0' || strlen(name) > NAME_MAX || !strcmp(name, "."))
+    return false;
+  if (inode_is_removed(dir->inode))
     return false;
 
   /* Check that NAME is not in use. */
@@ -135,23 +317,31 @@ bool dir_add(struct dir* dir, const char* name, block_sector_t inode_sector) {
      inode_read_at() will only return a short read at end of file.
      Otherwise, we'd need to verify that we didn't get a short
      read due to something intermittent such as low memory. */
-  for (ofs = 0; inode_read_at(dir->inode, &e, sizeof e, ofs) == sizeof e; ofs += sizeof e)
-    if (!e.in_use)
-      break;
+  if (is_hashed(dir)) {
+    if (!find_free_slot(dir, name, &ofs))
+      goto done;
+  } else {
+    for (ofs = 0; inode_read_at(dir->inode, &e, sizeof e, ofs) == sizeof e; ofs += sizeof e)
+      if (!e.in_use)
+        break;
+  }
 
   /* Write slot. */
   e.in_use = true;
   strlcpy(e.name, name, sizeof e.name);
   e.inode_sector = inode_sector;
   success = inode_write_at(dir->inode, &e, sizeof e, ofs) == sizeof e;
+  if (success)
+    dcache_add(inode_get_inumber(dir->inode), name, inode_sector);
 
 done:
   return success;
 }
 
 /* Removes any entry for NAME in DIR.
-   Returns true if successful, false on failure,
-   which occurs only if there is no file with the given NAME. */
+   Returns true if successful, false on failure, which occurs if
+   there is no file with the given NAME or if NAME is ".", "..",
+   the root directory or a directory that is not empty. */
 bool dir_remove(struct dir* dir, const char* name) {
   struct dir_entry e;
   struct inode* inode = NULL;
@@ -162,6 +352,8 @@ bool dir_remove(struct dir* dir, const char* name) {
   ASSERT(name != NULL);
 
   /* Find directory entry. */
+  if (!strcmp(name, ".") || !strcmp(name, ".."))
+    goto done;
   if (!lookup(dir, name, &e, &ofs))
     goto done;
 
@@ -170,12 +362,30 @@ bool dir_remove(struct dir* dir, const char* name) {
   if (inode == NULL)
     goto done;
 
-  /* Erase directory entry. */
+  /* Only empty directories other than the root may be removed. */
+  if (inode_is_dir(inode)) {
+    struct dir* victim;
+    bool empty;
+
+    if (e.inode_sector == ROOT_DIR_SECTOR)
+      goto done;
+    victim = dir_open(inode_reopen(inode));
+    empty = victim != NULL && dir_is_empty(victim);
+    dir_close(victim);
+    if (!empty)
+      goto done;
+  }
+
+  /* Erase directory entry, leaving its name behind as a
+     tombstone. */
   e.in_use = false;
   if (inode_write_at(dir->inode, &e, sizeof e, ofs) != sizeof e)
     goto done;
+  if (is_hashed(dir))
+    clear_tombstones(dir, ofs);
 
   /* Remove inode. */
+  dcache_add_absent(inode_get_inumber(dir->inode), name);
   inode_remove(inode);
   success = true;
 
@@ -184,18 +394,40 @@ done:
   return success;
 }
 
+/* Returns true if DIR contains no entries other than "..". */
+bool dir_is_empty(const struct dir* dir) {
+  struct dir_entry e;
+  off_t ofs;
+
+  for (ofs = 0; inode_read_at(dir->inode, &e, sizeof e, ofs) == sizeof e; ofs += sizeof e)
+    if (e.in_use && strcmp(e.name, ".."))
+      return false;
+  return true;
+}
+
 /* Reads the next directory entry in DIR and stores the name in
    NAME.  Returns true if successful, false if the directory
-   contains no more entries. */
+   contains no more entries.  The "." and ".." entries are never
+   returned. */
 bool dir_readdir(struct dir* dir, char name[NAME_MAX + 1]) {
   struct dir_entry e;
 
   while (inode_read_at(dir->inode, &e, sizeof e, dir->pos) == sizeof e) {
     dir->pos += sizeof e;
-    if (e.in_use) {
+    if (e.in_use && strcmp(e.name, ".") && strcmp(e.name, "..")) {
       strlcpy(name, e.name, NAME_MAX + 1);
       return true;
     }
   }
   return false;
 }
+
+/* Sets DIR's position for dir_readdir() to POS, a value
+   previously returned by dir_tell(). */
+void dir_seek(struct dir* dir, off_t pos) {
+  ASSERT(pos >= 0);
+  dir->pos = pos;
+}
+
+/* Returns DIR's current position for dir_readdir(). */
+off_t dir_tell(const struct dir* dir) { return dir->pos; }
@@ -6,11 +6,18 @@
 #include "filesys/free-map.h"
 #include "filesys/inode.h"
 #include "filesys/directory.h"
+#include "filesys/dcache.h"
+#include "filesys/journal.h"
+#include "threads/thread.h"
 
 /* Partition that contains the file system. */
 struct block* fs_device;
 
+/* Number of entries in a newly created directory. */
+#define DIR_ENTRY_CNT 16
+
 static void do_format(void);
+static struct dir* resolve_path(const char* path, char name[NAME_MAX + 1]);
 
 /* Initializes the file system module.
    If FORMAT is true, reformats the file system. */
@@ -20,10 +27,14 @@ void filesys_init(bool format) {
     PANIC("No file system device found, can't initialize file system.");
 
   inode_init();
+  dcache_init();
+  journal_init();
   free_map_init();
 
   if (format)
     do_format();
+  else
+    journal_recover();
 
   free_map_open();
 }
@@ -33,54 +44,206 @@ void filesys_init(bool format) {
 void filesys_done(void) { free_map_close(); }
 
 /* Creates a file named NAME with the given INITIAL_SIZE.
+   NAME may be an absolute or relative path.
    Returns true if successful, false otherwise.
    Fails if a file named NAME already exists,
    or if internal memory allocation fails. */
 bool filesys_create(const char* name, off_t initial_size) {
+  char part[NAME_MAX + 1];
   block_sector_t inode_sector = 0;
-  struct dir* dir = dir_open_root();
-  bool success = (dir != NULL && free_map_allocate(1, &inode_sector) &&
-                  inode_create(inode_sector, initial_size) && dir_add(dir, name, inode_sector));
+  struct dir* dir;
+  bool success;
+
+  journal_begin();
+  dir = resolve_path(name, part);
+  success = (dir != NULL && free_map_allocate(1, &inode_sector) &&
+             inode_create(inode_sector, initial_size, 0) && dir_add(dir, part, inode_sector));
   if (!success && inode_sector != 0)
     free_map_release(inode_sector, 1);
   dir_close(dir);
+  journal_end();
 
   return success;
 }
 
-/* Opens the file with the given NAME.
+/* Creates a directory named NAME, which may be an absolute or
+   relative path.
+   Returns true if successful, false otherwise.
+   Fails if a file named NAME already exists, if any directory
+   leading up to it does not exist, or if internal memory
+   allocation fails. */
+bool filesys_mkdir(const char* name) {
+  char part[NAME_MAX + 1];
+  block_sector_t inode_sector = 0;
+  struct dir* dir;
+  bool success;
+
+  journal_begin();
+  dir = resolve_path(name, part);
+  success = (dir != NULL && free_map_allocate(1, &inode_sector) &&
+             dir_create(inode_sector, DIR_ENTRY_CNT, inode_get_inumber(dir_get_inode(dir))) &&
+             dir_add(dir, part, inode_sector));
+  if (!success && inode_sector != 0)
+    free_map_release(inode_sector, 1);
+  dir_close(dir);
+  journal_end();
+
+  return success;
+}
+
+/* Opens the file or directory with the given NAME, which may be
+   an absolute or relative path.
    Returns the new file if successful or a null pointer
    otherwise.
    Fails if no file named NAME exists,
    or if an internal memory allocation fails. */
 struct file* filesys_open(const char* name) {
-  struct dir* dir = dir_open_root();
+  char part[NAME_MAX + 1];
+  struct dir* dir = resolve_path(name, part);
   struct inode* inode = NULL;
 
   if (dir != NULL)
-    dir_lookup(dir, name, &inode);
+    dir_lookup(dir, part, &inode);
   dir_close(dir);
 
   return file_open(inode);
 }
 
-/* Deletes the file named NAME.
+/* Deletes the file or empty directory named NAME, which may be an
+   absolute or relative path.
    Returns true if successful, false on failure.
    Fails if no file named NAME exists,
    or if an internal memory allocation fails. */
 bool filesys_remove(const char* name) {
-  struct dir* dir = dir_open_root();
-  bool success = dir != NULL && dir_remove(dir, name);
+  char part[NAME_MAX + 1];
+  struct dir* dir;
+  bool success;
+
+  journal_begin();
+  dir = resolve_path(name, part);
+  success = dir != NULL && dir_remove(dir, part);
   dir_close(dir);
+  journal_end();
 
   return success;
 }
 
+/* Changes the running thread's current directory to NAME.
+   Returns true if successful, false if NAME does not exist or is
+   not a directory. */
+bool filesys_chdir(const char* name) {
+  char part[NAME_MAX + 1];
+  struct thread* t = thread_current();
+  struct dir* dir = resolve_path(name, part);
+  struct inode* inode = NULL;
+
+  if (dir != NULL)
+    dir_lookup(dir, part, &inode);
+  dir_close(dir);
+
+  if (inode == NULL)
+    return false;
+  if (!inode_is_dir(inode)) {
+    inode_close(inode);
+    return false;
+  }
+  dir_close(t->cwd);
+  t->cwd = dir_open(inode);
+  return t->cwd != NULL;
+}
+
+/* Extracts a file name part from *SRCP into PART, and updates
+   *SRCP so that the next call will return the next file name
+   part.  Returns 1 if successful, 0 at end of string, -1 for a
+   too-long file name part. */
+static int get_next_part(char part[NAME_MAX + 1], const char** srcp) {
+  const char* src = *srcp;
+  char* dst = part;
+
+  /* Skip leading slashes.  If it's all slashes, we're done. */
+  while (*src == '/')
+    src++;
+  if (*src == '\0')
+    return 0;
+
+  /* Copy up to NAME_MAX character from SRC to DST.  Add null
+     terminator. */
+  while (*src != '/' && *src != '\0') {
+    if (dst < part + NAME_MAX)
+      *dst++ = *src;
+    else
+      return -1;
+    src++;
+  }
+  *dst = '\0';
+
+  /* Advance source pointer. */
+  *srcp = src;
+  return 1;
+}
+
+/* Walks PATH, which is absolute if it starts with "/" and
+   otherwise relative to the running thread's current directory,
+   up to its final component.  Returns the directory that should
+   contain that component, which the caller must close, and
+   copies the component into NAME.  A PATH with no components,
+   such as "/", yields NAME ".".
+   Returns a null pointer if PATH is empty, if a component is too
+   long, or if a directory along the way does not exist. */
+static struct dir* resolve_path(const char* path, char name[NAME_MAX + 1]) {
+  struct dir* cwd = thread_current()->cwd;
+  struct dir* dir;
+  int result;
+
+  if (*path == '\0')
+    return NULL;
+  if (*path == '/' || cwd == NULL)
+    dir = dir_open_root();
+  else
+    dir = dir_reopen(cwd);
+  if (dir == NULL)
+    return NULL;
+
+  result = get_next_part(name, &path);
+  if (result == 0)
+    strlcpy(name, ".", NAME_MAX + 1);
+  while (result > 0) {
+    char next[NAME_MAX + 1];
+    struct inode* inode;
+
+    result = get_next_part(next, &path);
+    if (result == 0)
+      return dir;
+    if (result < 0)
+      break;
+
+    /* NAME is an intermediate component, so it must be a
+       directory. */
+    if (!dir_lookup(dir, name, &inode))
+      break;
+    dir_close(dir);
+    if (!inode_is_dir(inode)) {
+      inode_close(inode);
+      return NULL;
+    }
+    dir = dir_open(inode);
+    if (dir == NULL)
+      return NULL;
+    strlcpy(name, next, NAME_MAX + 1);
+  }
+  if (result == 0)
+    return dir;
+
+  dir_close(dir);
+  return NULL;
+}
+
 /* Formats the file system. */
 static void do_format(void) {
   printf("Formatting file system...");
+  journal_format();
   free_map_create();
-  if (!dir_create(ROOT_DIR_SECTOR, 16))
+  if (!dir_create(ROOT_DIR_SECTOR, DIR_ENTRY_CNT, ROOT_DIR_SECTOR))
     PANIC("root directory creation failed");
   free_map_close();
   printf("done.\n");
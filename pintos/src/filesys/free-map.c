@@ -1,20 +1,35 @@
 #include "filesys/free-map.h"
 #include <bitmap.h>
 #include <debug.h>
+#include <limits.h>
+#include <round.h>
 #include "filesys/file.h"
 #include "filesys/filesys.h"
 #include "filesys/inode.h"
+#include "filesys/journal.h"
+
+/* Number of free map bits stored in one sector of the free map
+   file. */
+#define BITS_PER_SECTOR (BLOCK_SECTOR_SIZE * CHAR_BIT)
 
 static struct file* free_map_file; /* Free map file. */
 static struct bitmap* free_map;    /* Free map, one bit per sector. */
+static struct bitmap* dirty_map;   /* Free map file sectors not yet written. */
+static block_sector_t next_sector; /* Where to start looking for free sectors. */
+
+static void mark_dirty(block_sector_t, size_t cnt);
 
 /* Initializes the free map. */
 void free_map_init(void) {
   free_map = bitmap_create(block_size(fs_device));
   if (free_map == NULL)
     PANIC("bitmap creation failed--file system device is too large");
+  dirty_map = bitmap_create(DIV_ROUND_UP(bitmap_file_size(free_map), BLOCK_SECTOR_SIZE));
+  if (dirty_map == NULL)
+    PANIC("dirty map creation failed");
   bitmap_mark(free_map, FREE_MAP_SECTOR);
   bitmap_mark(free_map, ROOT_DIR_SECTOR);
+  bitmap_set_multiple(free_map, JOURNAL_SECTOR, JOURNAL_SECTORS, true);
 }
 
 /* Allocates CNT consecutive sectors from the free map and stores
@@ -23,10 +38,18 @@ void free_map_init(void) {
    sectors were available or if the free_map file could not be
    written. */
 bool free_map_allocate(size_t cnt, block_sector_t* sectorp) {
-  block_sector_t sector = bitmap_scan_and_flip(free_map, 0, cnt, false);
-  if (sector != BITMAP_ERROR && free_map_file != NULL && !bitmap_write(free_map, free_map_file)) {
-    bitmap_set_multiple(free_map, sector, cnt, false);
-    sector = BITMAP_ERROR;
+  /* Next fit: carry on from the last allocation, so that the
+     scan does not cross the allocated start of the disk every
+     time. */
+  block_sector_t sector = bitmap_scan_wrap(free_map, next_sector, cnt, false);
+  if (sector != BITMAP_ERROR) {
+    bitmap_set_multiple(free_map, sector, cnt, true);
+    next_sector = sector + cnt;
+    mark_dirty(sector, cnt);
+    if (!free_map_flush()) {
+      bitmap_set_multiple(free_map, sector, cnt, false);
+      sector = BITMAP_ERROR;
+    }
   }
   if (sector != BITMAP_ERROR)
     *sectorp = sector;
@@ -37,7 +60,40 @@ bool free_map_allocate(size_t cnt, block_sector_t* sectorp) {
 void free_map_release(block_sector_t sector, size_t cnt) {
   ASSERT(bitmap_all(free_map, sector, cnt));
   bitmap_set_multiple(free_map, sector, cnt, false);
-  bitmap_write(free_map, free_map_file);
+  mark_dirty(sector, cnt);
+  free_map_flush();
+}
+
+/* Records that the free map file sectors holding the bits for
+   sectors SECTOR through SECTOR + CNT - 1 must be rewritten. */
+static void mark_dirty(block_sector_t sector, size_t cnt) {
+  size_t first, last;
+
+  if (cnt == 0)
+    return;
+  first = sector / BITS_PER_SECTOR;
+  last = (sector + cnt - 1) / BITS_PER_SECTOR;
+  bitmap_set_multiple(dirty_map, first, last - first + 1, true);
+}
+
+/* Writes the dirty sectors of the free map to the free map file,
+   leaving the rest of the file untouched, so that each
+   allocation or release costs O(1) sector writes regardless of
+   the size of the device.
+   Returns true if successful or if the free map file is not
+   open yet, false if a write failed. */
+bool free_map_flush(void) {
+  size_t idx = 0;
+
+  if (free_map_file == NULL)
+    return true;
+
+  while ((idx = bitmap_scan(dirty_map, idx, 1, true)) != BITMAP_ERROR) {
+    if (!bitmap_write_bytes(free_map, free_map_file, idx * BLOCK_SECTOR_SIZE, BLOCK_SECTOR_SIZE))
+      return false;
+    bitmap_reset(dirty_map, idx);
+  }
+  return true;
 }
 
 /* Opens the free map file and reads it from disk. */
@@ -47,16 +103,22 @@ void free_map_open(void) {
     PANIC("can't open free map");
   if (!bitmap_read(free_map, free_map_file))
     PANIC("can't read free map");
+  bitmap_set_all(dirty_map, false);
 }
 
 /* Writes the free map to disk and closes the free map file. */
-void free_map_close(void) { file_close(free_map_file); }
+void free_map_close(void) {
+  if (!free_map_flush())
+    PANIC("can't write free map");
+  file_close(free_map_file);
+  free_map_file = NULL;
+}
 
 /* Creates a new free map file on disk and writes the free map to
    it. */
 void free_map_create(void) {
   /* Create inode. */
-  if (!inode_create(FREE_MAP_SECTOR, bitmap_file_size(free_map)))
+  if (!inode_create(FREE_MAP_SECTOR, bitmap_file_size(free_map), 0))
     PANIC("free map creation failed");
 
   /* Write bitmap to file. */
@@ -65,4 +127,5 @@ void free_map_create(void) {
     PANIC("can't open free map");
   if (!bitmap_write(free_map, free_map_file))
     PANIC("can't write free map");
+  bitmap_set_all(dirty_map, false);
 }
@@ -1,11 +1,14 @@
 #include "filesys/inode.h"
-#include <list.h>
+#include <hash.h>
+#include <ohash.h>
 #include <debug.h>
 #include <round.h>
 #include <string.h>
 #include "filesys/filesys.h"
 #include "filesys/free-map.h"
+#include "filesys/journal.h"
 #include "threads/malloc.h"
+#include "threads/synch.h"
 
 /* Identifies an inode. */
 #define INODE_MAGIC 0x494e4f44
@@ -16,7 +19,8 @@ struct inode_disk {
   block_sector_t start; /* First data sector. */
   off_t length;         /* File size in bytes. */
   unsigned magic;       /* Magic number. */
-  uint32_t unused[125]; /* Not used. */
+  uint32_t flags;       /* INODE_* type and format bits. */
+  uint32_t unused[124]; /* Not used. */
 };
 
 /* Returns the number of sectors to allocate for an inode SIZE
@@ -25,7 +29,7 @@ static inline size_t bytes_to_sectors(off_t size) { return DIV_ROUND_UP(size, BL
 
 /* In-memory inode. */
 struct inode {
-  struct list_elem elem;  /* Element in inode list. */
+  struct ohash_elem elem; /* Element in open_inodes table. */
   block_sector_t sector;  /* Sector number of disk location. */
   int open_cnt;           /* Number of openers. */
   bool removed;           /* True if deleted, false otherwise. */
@@ -45,19 +49,86 @@ static block_sector_t byte_to_sector(const struct inode* inode, off_t pos) {
     return -1;
 }
 
-/* List of open inodes, so that opening a single inode twice
-   returns the same `struct inode'. */
-static struct list open_inodes;
+/* Returns true if INODE's contents are file system metadata,
+   whose writes must go through the journal. */
+static bool is_metadata(const struct inode* inode) {
+  return inode_is_dir(inode) || inode->sector == FREE_MAP_SECTOR;
+}
+
+/* Writes BUFFER to SECTOR, which holds part of INODE's contents:
+   through the journal if they are metadata, otherwise directly. */
+static void write_sector(const struct inode* inode, block_sector_t sector, const void* buffer) {
+  if (is_metadata(inode))
+    journal_write(sector, buffer);
+  else {
+    journal_forget(sector);
+    block_write(fs_device, sector, buffer);
+  }
+}
+
+/* Returns the number of whole sectors of INODE's contents,
+   starting at sector-aligned OFFSET and not exceeding SIZE bytes,
+   that may be transferred in one block device request.  File
+   data is contiguous on disk, but metadata must pass through the
+   journal one sector at a time. */
+static size_t sector_run(const struct inode* inode, off_t size, off_t offset) {
+  off_t left = inode_length(inode) - offset;
+
+  ASSERT(offset % BLOCK_SECTOR_SIZE == 0);
+  if (is_metadata(inode))
+    return 1;
+  return (size < left ? size : left) / BLOCK_SECTOR_SIZE;
+}
+
+/* Table of open inodes, keyed on sector, so that opening a
+   single inode twice returns the same `struct inode'.  Lookups,
+   insertions, removals and changes to any inode's open_cnt are
+   all made while holding open_inodes_lock. */
+static struct ohash open_inodes;
+static struct lock open_inodes_lock;
+
+static ohash_hash_func inode_hash;
+static ohash_equal_func inode_equal;
+static struct inode* find_open_inode(block_sector_t);
 
 /* Initializes the inode module. */
-void inode_init(void) { list_init(&open_inodes); }
+void inode_init(void) {
+  if (!ohash_init(&open_inodes, inode_hash, inode_equal, NULL))
+    PANIC("open inode table creation failed");
+  lock_init(&open_inodes_lock);
+}
+
+/* Returns a hash value for the inode containing E. */
+static unsigned inode_hash(const struct ohash_elem* e, void* aux UNUSED) {
+  return hash_int(ohash_entry(e, struct inode, elem)->sector);
+}
+
+/* Returns true if the inodes containing A and B have the same
+   sector number. */
+static bool inode_equal(const struct ohash_elem* a, const struct ohash_elem* b, void* aux UNUSED) {
+  return ohash_entry(a, struct inode, elem)->sector == ohash_entry(b, struct inode, elem)->sector;
+}
+
+/* Returns the open inode for SECTOR, or a null pointer if SECTOR
+   is not open.  Must be called with open_inodes_lock held. */
+static struct inode* find_open_inode(block_sector_t sector) {
+  /* Search key.  Kept static, under open_inodes_lock, rather
+     than putting a sector-sized inode on the kernel stack. */
+  static struct inode key;
+  struct ohash_elem* e;
+
+  ASSERT(lock_held_by_current_thread(&open_inodes_lock));
+  key.sector = sector;
+  e = ohash_find(&open_inodes, &key.elem);
+  return e != NULL ? ohash_entry(e, struct inode, elem) : NULL;
+}
 
 /* Initializes an inode with LENGTH bytes of data and
    writes the new inode to sector SECTOR on the file system
-   device.
+   device, with the INODE_* bits in FLAGS.
    Returns true if successful.
    Returns false if memory or disk allocation fails. */
-bool inode_create(block_sector_t sector, off_t length) {
+bool inode_create(block_sector_t sector, off_t length, unsigned flags) {
   struct inode_disk* disk_inode = NULL;
   bool success = false;
 
@@ -72,14 +143,19 @@ bool inode_create(block_sector_t sector, off_t length) {
     size_t sectors = bytes_to_sectors(length);
     disk_inode->length = length;
     disk_inode->magic = INODE_MAGIC;
+    disk_inode->flags = flags;
     if (free_map_allocate(sectors, &disk_inode->start)) {
-      block_write(fs_device, sector, disk_inode);
+      journal_write(sector, disk_inode);
       if (sectors > 0) {
         static char zeros[BLOCK_SECTOR_SIZE];
         size_t i;
 
-        for (i = 0; i < sectors; i++)
+        /* The new sectors are not reachable until the inode's
+           transaction commits, so they need not be journaled. */
+        for (i = 0; i < sectors; i++) {
+          journal_forget(disk_inode->start + i);
           block_write(fs_device, disk_inode->start + i, zeros);
+        }
       }
       success = true;
     }
@@ -92,37 +168,54 @@ bool inode_create(block_sector_t sector, off_t length) {
    and returns a `struct inode' that contains it.
    Returns a null pointer if memory allocation fails. */
 struct inode* inode_open(block_sector_t sector) {
-  struct list_elem* e;
   struct inode* inode;
+  struct inode* open;
 
   /* Check whether this inode is already open. */
-  for (e = list_begin(&open_inodes); e != list_end(&open_inodes); e = list_next(e)) {
-    inode = list_entry(e, struct inode, elem);
-    if (inode->sector == sector) {
-      inode_reopen(inode);
-      return inode;
-    }
-  }
+  lock_acquire(&open_inodes_lock);
+  inode = find_open_inode(sector);
+  if (inode != NULL)
+    inode->open_cnt++;
+  lock_release(&open_inodes_lock);
+  if (inode != NULL)
+    return inode;
 
   /* Allocate memory. */
   inode = malloc(sizeof *inode);
   if (inode == NULL)
     return NULL;
 
-  /* Initialize. */
-  list_push_front(&open_inodes, &inode->elem);
+  /* Initialize, reading the disk inode without holding the
+     lock. */
   inode->sector = sector;
   inode->open_cnt = 1;
   inode->deny_write_cnt = 0;
   inode->removed = false;
-  block_read(fs_device, inode->sector, &inode->data);
+  journal_read(inode->sector, &inode->data);
+
+  /* Another thread may have opened the same inode while we were
+     reading it.  If so, use its copy and discard ours. */
+  lock_acquire(&open_inodes_lock);
+  open = find_open_inode(sector);
+  if (open != NULL)
+    open->open_cnt++;
+  else
+    ohash_insert(&open_inodes, &inode->elem);
+  lock_release(&open_inodes_lock);
+  if (open != NULL) {
+    free(inode);
+    inode = open;
+  }
   return inode;
 }
 
 /* Reopens and returns INODE. */
 struct inode* inode_reopen(struct inode* inode) {
-  if (inode != NULL)
+  if (inode != NULL) {
+    lock_acquire(&open_inodes_lock);
     inode->open_cnt++;
+    lock_release(&open_inodes_lock);
+  }
   return inode;
 }
 
@@ -133,19 +226,27 @@ block_sector_t inode_get_inumber(const struct inode* inode) { return inode->sect
    If this was the last reference to INODE, frees its memory.
    If INODE was also a removed inode, frees its blocks. */
 void inode_close(struct inode* inode) {
+  bool last;
+
   /* Ignore null pointer. */
   if (inode == NULL)
     return;
 
   /* Release resources if this was the last opener. */
-  if (--inode->open_cnt == 0) {
-    /* Remove from inode list and release lock. */
-    list_remove(&inode->elem);
+  lock_acquire(&open_inodes_lock);
+  last = --inode->open_cnt == 0;
+  if (last)
+    ohash_delete(&open_inodes, &inode->elem);
+  lock_release(&open_inodes_lock);
+
+  if (last) {
 
     /* Deallocate blocks if removed. */
     if (inode->removed) {
+      journal_begin();
       free_map_release(inode->sector, 1);
       free_map_release(inode->data.start, bytes_to_sectors(inode->data.length));
+      journal_end();
     }
 
     free(inode);
@@ -159,6 +260,9 @@ void inode_remove(struct inode* inode) {
   inode->removed = true;
 }
 
+/* Returns true if INODE has been marked for deletion. */
+bool inode_is_removed(const struct inode* inode) { return inode->removed; }
+
 /* Reads SIZE bytes from INODE into BUFFER, starting at position OFFSET.
    Returns the number of bytes actually read, which may be less
    than SIZE if an error occurs or end of file is reached. */
@@ -183,8 +287,13 @@ off_t inode_read_at(struct inode* inode, void* buffer_, off_t size, off_t offset
       break;
 
     if (sector_ofs == 0 && chunk_size == BLOCK_SECTOR_SIZE) {
-      /* Read full sector directly into caller's buffer. */
-      block_read(fs_device, sector_idx, buffer + bytes_read);
+      /* Read full sectors directly into caller's buffer. */
+      size_t cnt = sector_run(inode, size, offset);
+      if (cnt > 1) {
+        block_read_multiple(fs_device, sector_idx, cnt, buffer + bytes_read);
+        chunk_size = cnt * BLOCK_SECTOR_SIZE;
+      } else
+        journal_read(sector_idx, buffer + bytes_read);
     } else {
       /* Read sector into bounce buffer, then partially copy
              into caller's buffer. */
@@ -193,7 +302,7 @@ off_t inode_read_at(struct inode* inode, void* buffer_, off_t size, off_t offset
         if (bounce == NULL)
           break;
       }
-      block_read(fs_device, sector_idx, bounce);
+      journal_read(sector_idx, bounce);
       memcpy(buffer + bytes_read, bounce + sector_ofs, chunk_size);
     }
 
@@ -236,8 +345,16 @@ off_t inode_write_at(struct inode* inode, const void* buffer_, off_t size, off_t
       break;
 
     if (sector_ofs == 0 && chunk_size == BLOCK_SECTOR_SIZE) {
-      /* Write full sector directly to disk. */
-      block_write(fs_device, sector_idx, buffer + bytes_written);
+      /* Write full sectors directly to disk. */
+      size_t cnt = sector_run(inode, size, offset);
+      if (cnt > 1) {
+        size_t i;
+        for (i = 0; i < cnt; i++)
+          journal_forget(sector_idx + i);
+        block_write_multiple(fs_device, sector_idx, cnt, buffer + bytes_written);
+        chunk_size = cnt * BLOCK_SECTOR_SIZE;
+      } else
+        write_sector(inode, sector_idx, buffer + bytes_written);
     } else {
       /* We need a bounce buffer. */
       if (bounce == NULL) {
@@ -250,11 +367,11 @@ off_t inode_write_at(struct inode* inode, const void* buffer_, off_t size, off_t
              we're writing, then we need to read in the sector
              first.  Otherwise we start with a sector of all zeros. */
       if (sector_ofs > 0 || chunk_size < sector_left)
-        block_read(fs_device, sector_idx, bounce);
+        journal_read(sector_idx, bounce);
       else
         memset(bounce, 0, BLOCK_SECTOR_SIZE);
       memcpy(bounce + sector_ofs, buffer + bytes_written, chunk_size);
-      block_write(fs_device, sector_idx, bounce);
+      write_sector(inode, sector_idx, bounce);
     }
 
     /* Advance. */
@@ -285,3 +402,9 @@ void inode_allow_write(struct inode* inode) {
 
 /* Returns the length, in bytes, of INODE's data. */
 off_t inode_length(const struct inode* inode) { return inode->data.length; }
+
+/* Returns true if INODE is a directory. */
+bool inode_is_dir(const struct inode* inode) { return (inode->data.flags & INODE_DIR) != 0; }
+
+/* Returns INODE's INODE_* type and format bits. */
+unsigned inode_get_flags(const struct inode* inode) { return inode->data.flags; }
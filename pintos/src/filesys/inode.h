@@ -7,17 +7,24 @@
 
 struct bitmap;
 
+/* Type and format bits stored in an on-disk inode. */
+#define INODE_DIR 0x1        /* Inode is a directory. */
+#define INODE_DIR_HASHED 0x2 /* Directory entries are placed by name hash. */
+
 void inode_init(void);
-bool inode_create(block_sector_t, off_t);
+bool inode_create(block_sector_t, off_t, unsigned flags);
 struct inode* inode_open(block_sector_t);
 struct inode* inode_reopen(struct inode*);
 block_sector_t inode_get_inumber(const struct inode*);
 void inode_close(struct inode*);
 void inode_remove(struct inode*);
+bool inode_is_removed(const struct inode*);
 off_t inode_read_at(struct inode*, void*, off_t size, off_t offset);
 off_t inode_write_at(struct inode*, const void*, off_t size, off_t offset);
 void inode_deny_write(struct inode*);
 void inode_allow_write(struct inode*);
 off_t inode_length(const struct inode*);
+bool inode_is_dir(const struct inode*);
+unsigned inode_get_flags(const struct inode*);
 
 #endif /* filesys/inode.h */
@@ -0,0 +1,280 @@
+#include "filesys/journal.h"
+#include <debug.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include "devices/shutdown.h"
+#include "filesys/filesys.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+
+/* Write-ahead metadata journal.
+
+   Every operation that changes file system metadata (inodes,
+   directories and the free map) runs between journal_begin()
+   and journal_end().  Metadata sectors written meanwhile with
+   journal_write() are only buffered in memory, and
+   journal_read() returns the buffered copy of any sector that
+   has one, so the operation sees its own changes.
+
+   Operations that overlap in time join the same transaction,
+   which is committed when the last of them ends (group commit):
+   the buffered sectors are written to the journal area of the
+   file system device, then the journal header, which lists
+   their home sectors, is written as the commit record.  Only
+   then are the sectors written to their home locations, after
+   which the header is cleared again.
+
+   If the machine dies before the commit record reaches the disk,
+   none of the transaction's changes have been made.  If it dies
+   after, journal_recover() finds the commit record at the next
+   boot and redoes the home writes, in time proportional to the
+   length of the journal.
+
+   Ordinary file data is written directly, not journaled.  A
+   newly allocated data sector may still have a metadata write
+   pending in the running transaction, from its previous life,
+   so writers of file data call journal_forget() first. */
+
+/* Identifies a journal header. */
+#define JOURNAL_MAGIC 0x4a524e4c
+
+/* Number of free blocks that journal_begin() ensures the running
+   transaction has for each operation that joins it.  Must be at
+   least as many sectors as one operation writes. */
+#define JOURNAL_RESERVE 16
+
+/* On-disk journal header, in JOURNAL_SECTOR.
+   Must be exactly BLOCK_SECTOR_SIZE bytes long. */
+struct journal_header {
+  unsigned magic;                         /* Magic number. */
+  uint32_t seq;                           /* Transaction sequence number. */
+  uint32_t cnt;                           /* Number of blocks, 0 if empty. */
+  uint32_t checksum;                      /* Checksum of the blocks. */
+  block_sector_t sectors[JOURNAL_BLOCKS]; /* Home sector of each block. */
+  uint32_t unused[124 - JOURNAL_BLOCKS];  /* Not used. */
+};
+
+/* Running transaction. */
+static struct lock journal_lock;         /* Protects everything below. */
+static struct condition journal_idle;    /* Signaled after each commit. */
+static int handle_cnt;                   /* Operations in the transaction. */
+static size_t block_cnt;                 /* Blocks buffered so far. */
+static block_sector_t sectors[JOURNAL_BLOCKS]; /* Home sector of each block. */
+static uint8_t* blocks;                  /* JOURNAL_BLOCKS buffered sectors. */
+static struct journal_header header;     /* Commit record buffer. */
+static uint32_t seq;                     /* Last sequence number used. */
+
+/* Commits left until a simulated power failure, 0 for never. */
+static unsigned crash_countdown;
+
+static void commit(void);
+static uint32_t checksum(size_t cnt);
+static int find_block(block_sector_t);
+
+/* Initializes the journal module. */
+void journal_init(void) {
+  ASSERT(sizeof(struct journal_header) == BLOCK_SECTOR_SIZE);
+
+  lock_init(&journal_lock);
+  cond_init(&journal_idle);
+  blocks = palloc_get_multiple(PAL_ASSERT, JOURNAL_BLOCKS * BLOCK_SECTOR_SIZE / PGSIZE);
+}
+
+/* Writes an empty journal to the file system device. */
+void journal_format(void) {
+  memset(&header, 0, sizeof header);
+  header.magic = JOURNAL_MAGIC;
+  block_write(fs_device, JOURNAL_SECTOR, &header);
+}
+
+/* Redoes the home writes of a transaction whose commit record is
+   in the journal but which might not have been checkpointed
+   before the machine went down, then empties the journal. */
+void journal_recover(void) {
+  size_t i;
+
+  block_read(fs_device, JOURNAL_SECTOR, &header);
+  if (header.magic != JOURNAL_MAGIC)
+    PANIC("file system has no journal (reformat with -f)");
+  seq = header.seq;
+  if (header.cnt == 0)
+    return;
+  if (header.cnt > JOURNAL_BLOCKS)
+    PANIC("corrupt journal header");
+
+  block_read_multiple(fs_device, JOURNAL_SECTOR + 1, header.cnt, blocks);
+  if (checksum(header.cnt) == header.checksum) {
+    printf("Replaying journal transaction %" PRIu32 " (%" PRIu32 " sectors)...", header.seq,
+           header.cnt);
+    for (i = 0; i < header.cnt; i++)
+      block_write(fs_device, header.sectors[i], blocks + i * BLOCK_SECTOR_SIZE);
+    printf("done.\n");
+  }
+
+  header.cnt = 0;
+  block_write(fs_device, JOURNAL_SECTOR, &header);
+}
+
+/* Arranges for the machine to lose power, without syncing, right
+   after the COMMIT_CNT'th commit record from now is written and
+   before that transaction is checkpointed.  Used to test crash
+   recovery. */
+void journal_crash_after(unsigned commit_cnt) { crash_countdown = commit_cnt; }
+
+/* Starts an operation in the running transaction.  Operations
+   nest: only the outermost journal_begin() and journal_end()
+   calls in a thread take effect. */
+void journal_begin(void) {
+  struct thread* t = thread_current();
+
+  if (t->journal_depth++ > 0)
+    return;
+
+  /* Admit the operation only if the transaction has room for its
+     reserve on top of the reserves of the operations already in
+     it, which may not have written anything yet. */
+  lock_acquire(&journal_lock);
+  while (block_cnt + (handle_cnt + 1) * JOURNAL_RESERVE > JOURNAL_BLOCKS) {
+    if (handle_cnt == 0)
+      commit();
+    else
+      cond_wait(&journal_idle, &journal_lock);
+  }
+  handle_cnt++;
+  lock_release(&journal_lock);
+}
+
+/* Ends an operation started with journal_begin().  Commits the
+   running transaction if no other operation is still in it. */
+void journal_end(void) {
+  struct thread* t = thread_current();
+
+  ASSERT(t->journal_depth > 0);
+  if (--t->journal_depth > 0)
+    return;
+
+  lock_acquire(&journal_lock);
+  ASSERT(handle_cnt > 0);
+  if (--handle_cnt == 0)
+    commit();
+  lock_release(&journal_lock);
+}
+
+/* Reads SECTOR into BUFFER, seeing any change to it made in the
+   running transaction. */
+void journal_read(block_sector_t sector, void* buffer) {
+  int idx;
+
+  lock_acquire(&journal_lock);
+  idx = find_block(sector);
+  if (idx >= 0)
+    memcpy(buffer, blocks + idx * BLOCK_SECTOR_SIZE, BLOCK_SECTOR_SIZE);
+  lock_release(&journal_lock);
+
+  if (idx < 0)
+    block_read(fs_device, sector, buffer);
+}
+
+/* Writes BUFFER to metadata SECTOR as part of the running
+   transaction.  Outside journal_begin() and journal_end(), the
+   write forms a transaction by itself. */
+void journal_write(block_sector_t sector, const void* buffer) {
+  int idx;
+
+  if (thread_current()->journal_depth == 0) {
+    journal_begin();
+    journal_write(sector, buffer);
+    journal_end();
+    return;
+  }
+
+  lock_acquire(&journal_lock);
+  idx = find_block(sector);
+  if (idx < 0) {
+    if (block_cnt >= JOURNAL_BLOCKS)
+      PANIC("journal transaction too large");
+    idx = block_cnt++;
+    sectors[idx] = sector;
+  }
+  memcpy(blocks + idx * BLOCK_SECTOR_SIZE, buffer, BLOCK_SECTOR_SIZE);
+  lock_release(&journal_lock);
+}
+
+/* Drops any change to SECTOR from the running transaction,
+   because SECTOR is about to be written directly as file data. */
+void journal_forget(block_sector_t sector) {
+  int idx;
+
+  lock_acquire(&journal_lock);
+  idx = find_block(sector);
+  if (idx >= 0) {
+    block_cnt--;
+    sectors[idx] = sectors[block_cnt];
+    memcpy(blocks + idx * BLOCK_SECTOR_SIZE, blocks + block_cnt * BLOCK_SECTOR_SIZE,
+           BLOCK_SECTOR_SIZE);
+  }
+  lock_release(&journal_lock);
+}
+
+/* Commits and checkpoints the running transaction, which must
+   have no operations left in it.  Must be called with
+   journal_lock held. */
+static void commit(void) {
+  size_t i;
+
+  ASSERT(lock_held_by_current_thread(&journal_lock));
+  ASSERT(handle_cnt == 0);
+
+  if (block_cnt > 0) {
+    /* Write the blocks, then the commit record. */
+    block_write_multiple(fs_device, JOURNAL_SECTOR + 1, block_cnt, blocks);
+    memset(&header, 0, sizeof header);
+    header.magic = JOURNAL_MAGIC;
+    header.seq = ++seq;
+    header.cnt = block_cnt;
+    memcpy(header.sectors, sectors, block_cnt * sizeof *sectors);
+    header.checksum = checksum(block_cnt);
+    block_write(fs_device, JOURNAL_SECTOR, &header);
+
+    if (crash_countdown > 0 && --crash_countdown == 0)
+      shutdown_crash();
+
+    /* Checkpoint, then empty the journal. */
+    for (i = 0; i < block_cnt; i++)
+      block_write(fs_device, sectors[i], blocks + i * BLOCK_SECTOR_SIZE);
+    header.cnt = 0;
+    block_write(fs_device, JOURNAL_SECTOR, &header);
+    block_cnt = 0;
+  }
+  cond_broadcast(&journal_idle, &journal_lock);
+}
+
+/* Returns a checksum (32-bit FNV-1a) of the first CNT buffered
+   blocks and their home sectors as listed in `header'. */
+static uint32_t checksum(size_t cnt) {
+  const uint8_t* p = blocks;
+  const uint8_t* end = blocks + cnt * BLOCK_SECTOR_SIZE;
+  uint32_t hash = 2166136261u;
+  size_t i;
+
+  for (; p < end; p++)
+    hash = (hash ^ *p) * 16777619u;
+  for (i = 0; i < cnt; i++)
+    hash = (hash ^ header.sectors[i]) * 16777619u;
+  return hash;
+}
+
+/* Returns the index of the buffered block for SECTOR, or -1 if
+   the running transaction has not written SECTOR.  Must be
+   called with journal_lock held. */
+static int find_block(block_sector_t sector) {
+  size_t i;
+
+  for (i = 0; i < block_cnt; i++)
+    if (sectors[i] == sector)
+      return i;
+  return -1;
+}
@@ -0,0 +1,25 @@
+#ifndef FILESYS_JOURNAL_H
+#define FILESYS_JOURNAL_H
+
+#include "devices/block.h"
+
+/* Maximum number of sectors that one journal transaction may
+   change. */
+#define JOURNAL_BLOCKS 64
+
+/* Sectors reserved for the journal, starting at JOURNAL_SECTOR:
+   a header followed by one slot per block. */
+#define JOURNAL_SECTORS (JOURNAL_BLOCKS + 1)
+
+void journal_init(void);
+void journal_format(void);
+void journal_recover(void);
+void journal_crash_after(unsigned commit_cnt);
+
+void journal_begin(void);
+void journal_end(void);
+void journal_read(block_sector_t, void*);
+void journal_write(block_sector_t, const void*);
+void journal_forget(block_sector_t);
+
+#endif /* filesys/journal.h */
@@ -0,0 +1,41 @@
+#ifndef __LIB_KDATA_H
+#define __LIB_KDATA_H
+
+#include <stdint.h>
+
+/* Kernel data pages.
+
+   The kernel maps two read-only pages into every user process,
+   just below the lowest address a program is linked at, so that
+   the process can read some kernel state with an ordinary load
+   instead of a system call.
+
+   The first page, at KDATA_ADDR, is shared by every process and
+   holds system-wide values that the kernel updates on each timer
+   tick.  The second, at KDATA_PROC_ADDR, belongs to the process
+   and holds values that never change during its lifetime. */
+#define KDATA_ADDR ((void*)0x08046000)
+#define KDATA_PROC_ADDR ((void*)0x08047000)
+
+/* System-wide data, at KDATA_ADDR.
+
+   The kernel updates these members only from the timer interrupt
+   handler, so a process sees each update all at once, but a read
+   of more than one word may straddle an update.  A reader that
+   needs a consistent snapshot reads `seq', then the members it
+   wants, then `seq' again, and starts over if it changed. */
+struct kdata {
+  uint32_t seq;        /* Incremented by each update. */
+  int64_t ticks;       /* Timer ticks since the OS booted. */
+  int32_t load_avg;    /* 100 times the system load average. */
+  uint32_t timer_freq; /* Timer ticks per second. */
+  uint32_t boot_time;  /* Seconds since the Unix epoch at boot. */
+};
+
+/* Per-process data, at KDATA_PROC_ADDR. */
+struct kdata_proc {
+  int pid;  /* Process identifier. */
+  int ppid; /* Identifier of the process that started this one. */
+};
+
+#endif /* lib/kdata.h */
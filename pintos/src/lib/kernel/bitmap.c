@@ -50,6 +50,19 @@ static inline elem_type last_mask(const struct bitmap* b) {
   return last_bits ? ((elem_type)1 << last_bits) - 1 : (elem_type)-1;
 }
 
+/* Returns the bits of element E that equal VALUE as 1-bits. */
+static inline elem_type elem_match(elem_type e, bool value) { return value ? e : ~e; }
+
+/* Returns the number of 1-bits in E. */
+static inline unsigned elem_popcount(elem_type e) {
+  e = e - ((e >> 1) & 0x55555555);
+  e = (e & 0x33333333) + ((e >> 2) & 0x33333333);
+  e = (e + (e >> 4)) & 0x0f0f0f0f;
+  return (e * 0x01010101) >> 24;
+}
+
+static size_t find_bit(const struct bitmap*, size_t start, size_t end, bool value);
+
 /* Creation and destruction. */
 
 /* Creates and returns a pointer to a newly allocated bitmap with room for
@@ -186,26 +199,29 @@ size_t bitmap_count(const struct bitmap* b, size_t start, size_t cnt, bool value
   ASSERT(start <= b->bit_cnt);
   ASSERT(start + cnt <= b->bit_cnt);
 
+  /* Count 1-bits a word at a time, masking off the bits outside
+     the range in the first and last words. */
   value_cnt = 0;
-  for (i = 0; i < cnt; i++)
-    if (bitmap_test(b, start + i) == value)
-      value_cnt++;
-  return value_cnt;
+  for (i = start; i < start + cnt; i = (elem_idx(i) + 1) * ELEM_BITS) {
+    elem_type e = b->bits[elem_idx(i)];
+    size_t word_end = (elem_idx(i) + 1) * ELEM_BITS;
+
+    e &= ~(bit_mask(i) - 1);
+    if (start + cnt < word_end)
+      e &= bit_mask(start + cnt) - 1;
+    value_cnt += elem_popcount(e);
+  }
+  return value ? value_cnt : cnt - value_cnt;
 }
 
 /* Returns true if any bits in B between START and START + CNT,
    exclusive, are set to VALUE, and false otherwise. */
 bool bitmap_contains(const struct bitmap* b, size_t start, size_t cnt, bool value) {
-  size_t i;
-
   ASSERT(b != NULL);
   ASSERT(start <= b->bit_cnt);
   ASSERT(start + cnt <= b->bit_cnt);
 
-  for (i = 0; i < cnt; i++)
-    if (bitmap_test(b, start + i) == value)
-      return true;
-  return false;
+  return find_bit(b, start, start + cnt, value) < start + cnt;
 }
 
 /* Returns true if any bits in B between START and START + CNT,
@@ -228,6 +244,30 @@ bool bitmap_all(const struct bitmap* b, size_t start, size_t cnt) {
 
 /* Finding set or unset bits. */
 
+/* Returns the index of the first bit in B between START and END,
+   exclusive, that is set to VALUE, or END if there is none.
+   Skips whole elements that contain no such bit and finds the
+   bit within an element with a single bit scan. */
+static size_t find_bit(const struct bitmap* b, size_t start, size_t end, bool value) {
+  size_t idx;
+  elem_type e;
+
+  if (start >= end)
+    return end;
+
+  /* Ignore bits below START in the first element. */
+  idx = elem_idx(start);
+  e = elem_match(b->bits[idx], value) & ~(bit_mask(start) - 1);
+  while (e == 0) {
+    if (++idx >= elem_cnt(end))
+      return end;
+    e = elem_match(b->bits[idx], value);
+  }
+
+  start = idx * ELEM_BITS + __builtin_ctzl(e);
+  return start < end ? start : end;
+}
+
 /* Finds and returns the starting index of the first group of CNT
    consecutive bits in B at or after START that are all set to
    VALUE.
@@ -236,16 +276,35 @@ size_t bitmap_scan(const struct bitmap* b, size_t start, size_t cnt, bool value)
   ASSERT(b != NULL);
   ASSERT(start <= b->bit_cnt);
 
+  if (cnt == 0)
+    return start;
   if (cnt <= b->bit_cnt) {
     size_t last = b->bit_cnt - cnt;
-    size_t i;
-    for (i = start; i <= last; i++)
-      if (!bitmap_contains(b, i, cnt, !value))
+    size_t i = start;
+
+    /* Jump to the next bit set to VALUE, then to the end of the
+       run it starts.  A short run is skipped in one step. */
+    while ((i = find_bit(b, i, last + 1, value)) <= last) {
+      size_t run_end = find_bit(b, i, i + cnt, !value);
+      if (run_end == i + cnt)
         return i;
+      i = run_end + 1;
+    }
   }
   return BITMAP_ERROR;
 }
 
+/* Like bitmap_scan(), but if there is no group at or after START,
+   goes on to look for one that starts before START.  Passing the
+   end of the previous group found as START gives next-fit
+   allocation. */
+size_t bitmap_scan_wrap(const struct bitmap* b, size_t start, size_t cnt, bool value) {
+  size_t idx = bitmap_scan(b, start, cnt, value);
+  if (idx == BITMAP_ERROR && start > 0)
+    idx = bitmap_scan(b, 0, cnt, value);
+  return idx;
+}
+
 /* Finds the first group of CNT consecutive bits in B at or after
    START that are all set to VALUE, flips them all to !VALUE,
    and returns the index of the first bit in the group.
@@ -284,6 +343,20 @@ bool bitmap_write(const struct bitmap* b, struct file* file) {
   off_t size = byte_cnt(b->bit_cnt);
   return file_write_at(file, b->bits, size, 0) == size;
 }
+
+/* Writes bytes OFS through OFS + SIZE - 1 of B's file
+   representation, clipped to bitmap_file_size(B), to the same
+   offsets in FILE.  Bit K of B lives in byte K / CHAR_BIT, so
+   callers can persist just the part of B they changed.  Returns
+   true if successful, false otherwise. */
+bool bitmap_write_bytes(const struct bitmap* b, struct file* file, size_t ofs, size_t size) {
+  size_t file_size = byte_cnt(b->bit_cnt);
+  if (ofs >= file_size)
+    return true;
+  if (size > file_size - ofs)
+    size = file_size - ofs;
+  return file_write_at(file, (const uint8_t*)b->bits + ofs, size, ofs) == (off_t)size;
+}
 #endif /* FILESYS */
 
 /* Debugging. */
@@ -12,6 +12,7 @@
 #include "threads/vaddr.h"
 #include "devices/serial.h"
 #include "devices/shutdown.h"
+#include "devices/vga.h"
 
 /* Halts the OS, printing the source file name, line number, and
    function name, plus a user-specific message. */
@@ -39,6 +40,7 @@ void debug_panic(const char* file, int line, const char* function, const char* m
   }
 
   serial_flush();
+  vga_flush();
   shutdown();
   for (;;)
     ;
@@ -215,41 +215,102 @@ size_t hash_size(struct hash* h) { return h->elem_cnt; }
 /* Returns true if H contains no elements, false otherwise. */
 bool hash_empty(struct hash* h) { return h->elem_cnt == 0; }
 
-/* Fowler-Noll-Vo hash constants, for 32-bit word sizes. */
-#define FNV_32_PRIME 16777619u
-#define FNV_32_BASIS 2166136261u
+/* Constants for the 32-bit MurmurHash3 mix used by hash_bytes()
+   and hash_string(). */
+#define MURMUR_C1 0xcc9e2d51u
+#define MURMUR_C2 0x1b873593u
+#define MURMUR_SEED 0x9747b28cu
+
+/* 2**32 divided by the golden ratio, for multiplicative hashing
+   in hash_int(). */
+#define GOLDEN_32 0x9e3779b1u
+
+/* A 32-bit word that may alias any other type, for reading a
+   block of bytes a word at a time. */
+typedef uint32_t __attribute__((__may_alias__)) word_t;
+
+/* Returns X rotated left by R bits. */
+static inline uint32_t rotl(uint32_t x, int r) { return (x << r) | (x >> (32 - r)); }
+
+/* Scrambles the 4-byte block K before it is mixed into a hash. */
+static inline uint32_t murmur_block(uint32_t k) { return rotl(k * MURMUR_C1, 15) * MURMUR_C2; }
+
+/* Mixes the 4-byte block K into HASH. */
+static inline uint32_t murmur_mix(uint32_t hash, uint32_t k) {
+  return rotl(hash ^ murmur_block(k), 13) * 5 + 0xe6546b64;
+}
+
+/* Finishes HASH, over LENGTH bytes in all, whose last TAIL_CNT
+   bytes, fewer than 4, are in TAIL, so that every input bit
+   affects every output bit. */
+static inline uint32_t murmur_finish(uint32_t hash, uint32_t tail, size_t tail_cnt,
+                                     size_t length) {
+  if (tail_cnt > 0)
+    hash ^= murmur_block(tail);
+  hash ^= length;
+  hash ^= hash >> 16;
+  hash *= 0x85ebca6b;
+  hash ^= hash >> 13;
+  hash *= 0xc2b2ae35;
+  hash ^= hash >> 16;
+  return hash;
+}
 
 /* Returns a hash of the SIZE bytes in BUF. */
 unsigned hash_bytes(const void* buf_, size_t size) {
-  /* Fowler-Noll-Vo 32-bit hash, for bytes. */
+  /* MurmurHash3, 32-bit, 4 bytes per step.  x86 allows the
+     unaligned word loads. */
   const unsigned char* buf = buf_;
-  unsigned hash;
+  uint32_t hash, tail;
+  size_t i;
 
   ASSERT(buf != NULL);
 
-  hash = FNV_32_BASIS;
-  while (size-- > 0)
-    hash = (hash * FNV_32_PRIME) ^ *buf++;
+  hash = MURMUR_SEED;
+  for (i = 0; i + 4 <= size; i += 4)
+    hash = murmur_mix(hash, *(const word_t*)(buf + i));
 
-  return hash;
+  tail = 0;
+  for (; i < size; i++)
+    tail |= (uint32_t)buf[i] << (i % 4 * 8);
+  return murmur_finish(hash, tail, size % 4, size);
 }
 
-/* Returns a hash of string S. */
+/* Returns a hash of string S.  The result is the same as
+   hash_bytes (S, strlen (S)), computed in one pass. */
 unsigned hash_string(const char* s_) {
   const unsigned char* s = (const unsigned char*)s_;
-  unsigned hash;
+  uint32_t hash, word;
+  size_t length;
 
   ASSERT(s != NULL);
 
-  hash = FNV_32_BASIS;
-  while (*s != '\0')
-    hash = (hash * FNV_32_PRIME) ^ *s++;
+  /* Gather bytes into words as they are read, since reading
+     whole words could run off the end of the string. */
+  hash = MURMUR_SEED;
+  word = 0;
+  for (length = 0; s[length] != '\0'; length++) {
+    word |= (uint32_t)s[length] << (length % 4 * 8);
+    if (length % 4 == 3) {
+      hash = murmur_mix(hash, word);
+      word = 0;
+    }
+  }
+  return murmur_finish(hash, word, length % 4, length);
+}
 
-  return hash;
+/* Returns a hash of integer I.  Multiplying by GOLDEN_32 spreads
+   runs and strides of integers, such as sector numbers and page
+   addresses, evenly over the high bits; folding those into the
+   low bits suits tables that take the hash modulo a power of
+   2. */
+unsigned hash_int(int i) {
+  uint32_t hash = (uint32_t)i * GOLDEN_32;
+  return hash ^ (hash >> 16);
 }
 
-/* Returns a hash of integer I. */
-unsigned hash_int(int i) { return hash_bytes(&i, sizeof i); }
+/* Returns a hash of pointer P. */
+unsigned hash_ptr(const void* p) { return hash_int((uintptr_t)p); }
 
 /* Returns the bucket in H that E belongs in. */
 static struct list* find_bucket(struct hash* h, struct hash_elem* e) {
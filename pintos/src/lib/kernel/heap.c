@@ -0,0 +1,177 @@
+/* Binary heap.
+
+   See heap.h for basic information.  Elements move by relinking
+   rather than by copying, since they belong to the caller, so
+   the usual sift-up and sift-down steps exchange a node with its
+   child by rewiring the pointers around both. */
+
+#include "heap.h"
+#include "../debug.h"
+
+static struct heap_elem* find_node(struct heap*, size_t n);
+static void sift_up(struct heap*, struct heap_elem*);
+static void sift_down(struct heap*, struct heap_elem*);
+static void swap_with_child(struct heap*, struct heap_elem* parent, struct heap_elem* child);
+static void replace_link(struct heap*, struct heap_elem* old, struct heap_elem* new);
+
+/* Initializes H as an empty heap ordered by LESS, given
+   auxiliary data AUX. */
+void heap_init(struct heap* h, heap_less_func* less, void* aux) {
+  ASSERT(h != NULL);
+  ASSERT(less != NULL);
+
+  h->root = NULL;
+  h->size = 0;
+  h->less = less;
+  h->aux = aux;
+}
+
+/* Inserts E into H. */
+void heap_push(struct heap* h, struct heap_elem* e) {
+  ASSERT(e != NULL);
+
+  e->left = e->right = NULL;
+  h->size++;
+  if (h->size == 1) {
+    e->parent = NULL;
+    h->root = e;
+  } else {
+    struct heap_elem* parent = find_node(h, h->size / 2);
+    if (h->size % 2 == 0)
+      parent->left = e;
+    else
+      parent->right = e;
+    e->parent = parent;
+    sift_up(h, e);
+  }
+}
+
+/* Removes the least element from H and returns it.  H must not
+   be empty. */
+struct heap_elem* heap_pop(struct heap* h) {
+  struct heap_elem* top = h->root;
+
+  ASSERT(top != NULL);
+  heap_remove(h, top);
+  return top;
+}
+
+/* Removes E, which must be in H, from H. */
+void heap_remove(struct heap* h, struct heap_elem* e) {
+  struct heap_elem* last;
+
+  ASSERT(e != NULL);
+  ASSERT(h->size > 0);
+
+  /* Detach the last node, which has no children. */
+  last = find_node(h, h->size);
+  replace_link(h, last, NULL);
+  h->size--;
+
+  /* Unless E was the last node, move the last node into E's
+     place and let it find its level. */
+  if (last != e) {
+    last->parent = e->parent;
+    last->left = e->left;
+    last->right = e->right;
+    replace_link(h, e, last);
+    if (last->left != NULL)
+      last->left->parent = last;
+    if (last->right != NULL)
+      last->right->parent = last;
+    heap_update(h, last);
+  }
+}
+
+/* Moves E, which must be in H, to its proper place in H after
+   its key has changed in either direction. */
+void heap_update(struct heap* h, struct heap_elem* e) {
+  ASSERT(e != NULL);
+
+  sift_up(h, e);
+  sift_down(h, e);
+}
+
+/* Returns the least element in H, or a null pointer if H is
+   empty. */
+struct heap_elem* heap_top(struct heap* h) { return h->root; }
+
+/* Returns the number of elements in H. */
+size_t heap_size(struct heap* h) { return h->size; }
+
+/* Returns true if H is empty, false otherwise. */
+bool heap_empty(struct heap* h) { return h->root == NULL; }
+
+/* Returns the Nth node of H in level order, counting from 1.  N
+   must be between 1 and H's size. */
+static struct heap_elem* find_node(struct heap* h, size_t n) {
+  struct heap_elem* e = h->root;
+  int bit;
+
+  ASSERT(n >= 1 && n <= h->size);
+
+  for (bit = 30 - __builtin_clz(n); bit >= 0; bit--)
+    e = (n >> bit) & 1 ? e->right : e->left;
+  return e;
+}
+
+/* Moves E toward the root of H until its parent is not greater
+   than it. */
+static void sift_up(struct heap* h, struct heap_elem* e) {
+  while (e->parent != NULL && h->less(e, e->parent, h->aux))
+    swap_with_child(h, e->parent, e);
+}
+
+/* Moves E toward the leaves of H until neither child is less
+   than it. */
+static void sift_down(struct heap* h, struct heap_elem* e) {
+  for (;;) {
+    struct heap_elem* child = e->left;
+
+    if (child == NULL)
+      break;
+    if (e->right != NULL && h->less(e->right, child, h->aux))
+      child = e->right;
+    if (!h->less(child, e, h->aux))
+      break;
+    swap_with_child(h, e, child);
+  }
+}
+
+/* Exchanges the places of PARENT and its CHILD in H. */
+static void swap_with_child(struct heap* h, struct heap_elem* parent, struct heap_elem* child) {
+  struct heap_elem* left = child->left;
+  struct heap_elem* right = child->right;
+
+  replace_link(h, parent, child);
+  child->parent = parent->parent;
+  if (parent->left == child) {
+    child->left = parent;
+    child->right = parent->right;
+    if (child->right != NULL)
+      child->right->parent = child;
+  } else {
+    child->right = parent;
+    child->left = parent->left;
+    child->left->parent = child;
+  }
+
+  parent->parent = child;
+  parent->left = left;
+  parent->right = right;
+  if (left != NULL)
+    left->parent = parent;
+  if (right != NULL)
+    right->parent = parent;
+}
+
+/* Makes the link to OLD from its parent in H, or from H itself
+   if OLD is the root, point to NEW instead. */
+static void replace_link(struct heap* h, struct heap_elem* old, struct heap_elem* new) {
+  if (old->parent == NULL)
+    h->root = new;
+  else if (old->parent->left == old)
+    old->parent->left = new;
+  else
+    old->parent->right = new;
+}
@@ -0,0 +1,75 @@
+#ifndef __LIB_KERNEL_HEAP_H
+#define __LIB_KERNEL_HEAP_H
+
+/* Binary heap.
+
+   A priority queue that gives fast access to its least element,
+   as defined by a caller-supplied comparison function: finding
+   it takes O(1) time, and inserting an element, removing the
+   least or any other element, and restoring order after an
+   element's key changes take O(lg n) time.  Finding the least
+   element of a list with list_min() takes O(n) time instead.
+
+   A heap is usually stored in an array, but a heap of threads
+   waiting on a semaphore cannot allocate memory, so like lists
+   and hash tables this heap is intrusive.  Each structure that
+   can be in a heap embeds a struct heap_elem member, and
+   heap_entry() converts a pointer to that member back to a
+   pointer to the structure.  The elements are linked into a
+   complete binary tree with the least element at the root; the
+   path from the root to the Nth element, counting from 1 in
+   level order, is spelled out by the bits of N below the most
+   significant, 0 for left and 1 for right.
+
+   Elements that compare equal come out in no particular order.
+   To make a heap first-in, first-out among equal elements, break
+   ties with a sequence number in the comparison function.
+
+   If an element's key changes while it is in a heap, call
+   heap_update() on it before any other heap operation. */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Heap element. */
+struct heap_elem {
+  struct heap_elem* parent; /* Parent, or null for the root. */
+  struct heap_elem* left;   /* Left child, or null. */
+  struct heap_elem* right;  /* Right child, or null. */
+};
+
+/* Converts pointer to heap element HEAP_ELEM into a pointer to
+   the structure that HEAP_ELEM is embedded inside.  Supply the
+   name of the outer structure STRUCT and the member name MEMBER
+   of the heap element. */
+#define heap_entry(HEAP_ELEM, STRUCT, MEMBER)                                                      \
+  ((STRUCT*)((uint8_t*)&(HEAP_ELEM)->parent - offsetof(STRUCT, MEMBER.parent)))
+
+/* Compares the value of two heap elements A and B, given
+   auxiliary data AUX.  Returns true if A should come out of the
+   heap before B. */
+typedef bool heap_less_func(const struct heap_elem* a, const struct heap_elem* b, void* aux);
+
+/* Binary heap. */
+struct heap {
+  struct heap_elem* root; /* Least element, or null if empty. */
+  size_t size;            /* Number of elements. */
+  heap_less_func* less;   /* Comparison function. */
+  void* aux;              /* Auxiliary data for `less'. */
+};
+
+void heap_init(struct heap*, heap_less_func*, void* aux);
+
+/* Insertion and removal. */
+void heap_push(struct heap*, struct heap_elem*);
+struct heap_elem* heap_pop(struct heap*);
+void heap_remove(struct heap*, struct heap_elem*);
+void heap_update(struct heap*, struct heap_elem*);
+
+/* Properties. */
+struct heap_elem* heap_top(struct heap*);
+size_t heap_size(struct heap*);
+bool heap_empty(struct heap*);
+
+#endif /* lib/kernel/heap.h */
@@ -0,0 +1,374 @@
+/* Open-addressing hash table.
+
+   See ohash.h for basic information. */
+
+#include "ohash.h"
+#include "../debug.h"
+#include <string.h>
+#include "threads/malloc.h"
+
+/* Number of slots in a new table. */
+#define MIN_SLOT_CNT 8
+
+/* Number of old slots whose elements are moved to the new array
+   by each insertion or deletion while the table is growing.  Any
+   value of 2 or more finishes the move before the new array
+   needs to grow again. */
+#define MOVE_CNT 8
+
+/* Stands in for an element that has been moved out of or deleted
+   from `old_slots'.  Probes must continue past such a slot, so it
+   cannot simply be freed. */
+static struct ohash_elem moved;
+
+static void set_hash(struct ohash*, struct ohash_elem*);
+static struct ohash_slot* find_slot(struct ohash*, struct ohash_elem*);
+static struct ohash_slot* probe(struct ohash*, struct ohash_slot*, size_t slot_cnt,
+                                struct ohash_elem*);
+static void add_slot(struct ohash*, unsigned hash, struct ohash_elem*);
+static void remove_slot(struct ohash*, struct ohash_slot*);
+static void make_room(struct ohash*);
+static void move_old(struct ohash*, size_t cnt);
+
+/* Initializes open hash table H to compute hash values using
+   HASH and compare elements using EQUAL, given auxiliary data
+   AUX. */
+bool ohash_init(struct ohash* h, ohash_hash_func* hash, ohash_equal_func* equal, void* aux) {
+  h->elem_cnt = 0;
+  h->slot_cnt = MIN_SLOT_CNT;
+  h->used_cnt = 0;
+  h->slots = calloc(h->slot_cnt, sizeof *h->slots);
+  h->old_slots = NULL;
+  h->old_slot_cnt = 0;
+  h->old_idx = 0;
+  h->hash = hash;
+  h->equal = equal;
+  h->aux = aux;
+  return h->slots != NULL;
+}
+
+/* Removes all the elements from H.
+
+   If DESTRUCTOR is non-null, then it is called for each element
+   in the hash.  DESTRUCTOR may, if appropriate, deallocate the
+   memory used by the element.  However, modifying hash table H
+   while ohash_clear() is running, using any of the functions
+   ohash_clear(), ohash_destroy(), ohash_insert(),
+   ohash_replace(), or ohash_delete(), yields undefined behavior,
+   whether done in DESTRUCTOR or elsewhere. */
+void ohash_clear(struct ohash* h, ohash_action_func* destructor) {
+  if (destructor != NULL)
+    ohash_apply(h, destructor);
+
+  free(h->old_slots);
+  h->old_slots = NULL;
+  h->old_slot_cnt = 0;
+  memset(h->slots, 0, sizeof *h->slots * h->slot_cnt);
+  h->used_cnt = 0;
+  h->elem_cnt = 0;
+}
+
+/* Destroys open hash table H.
+
+   If DESTRUCTOR is non-null, then it is first called for each
+   element in the hash, with the same restrictions as in
+   ohash_clear(). */
+void ohash_destroy(struct ohash* h, ohash_action_func* destructor) {
+  if (destructor != NULL)
+    ohash_apply(h, destructor);
+  free(h->old_slots);
+  free(h->slots);
+}
+
+/* Inserts NEW into hash table H and returns a null pointer, if
+   no equal element is already in the table.
+   If an equal element is already in the table, returns it
+   without inserting NEW. */
+struct ohash_elem* ohash_insert(struct ohash* h, struct ohash_elem* new) {
+  struct ohash_slot* slot;
+
+  move_old(h, MOVE_CNT);
+  set_hash(h, new);
+  slot = find_slot(h, new);
+  if (slot != NULL)
+    return slot->elem;
+
+  make_room(h);
+  add_slot(h, new->hash, new);
+  h->elem_cnt++;
+  return NULL;
+}
+
+/* Inserts NEW into hash table H, replacing any equal element
+   already in the table, which is returned. */
+struct ohash_elem* ohash_replace(struct ohash* h, struct ohash_elem* new) {
+  struct ohash_slot* slot;
+  struct ohash_elem* old = NULL;
+
+  move_old(h, MOVE_CNT);
+  set_hash(h, new);
+  slot = find_slot(h, new);
+  if (slot != NULL) {
+    old = slot->elem;
+    remove_slot(h, slot);
+    h->elem_cnt--;
+  }
+
+  make_room(h);
+  add_slot(h, new->hash, new);
+  h->elem_cnt++;
+  return old;
+}
+
+/* Finds and returns an element equal to E in hash table H, or a
+   null pointer if no equal element exists in the table. */
+struct ohash_elem* ohash_find(struct ohash* h, struct ohash_elem* e) {
+  struct ohash_slot* slot;
+
+  set_hash(h, e);
+  slot = find_slot(h, e);
+  return slot != NULL ? slot->elem : NULL;
+}
+
+/* Finds, removes, and returns an element equal to E in hash
+   table H.  Returns a null pointer if no equal element existed
+   in the table.
+
+   If the elements of the hash table are dynamically allocated,
+   or own resources that are, then it is the caller's
+   responsibility to deallocate them. */
+struct ohash_elem* ohash_delete(struct ohash* h, struct ohash_elem* e) {
+  struct ohash_slot* slot;
+  struct ohash_elem* found;
+
+  move_old(h, MOVE_CNT);
+  set_hash(h, e);
+  slot = find_slot(h, e);
+  if (slot == NULL)
+    return NULL;
+
+  found = slot->elem;
+  remove_slot(h, slot);
+  h->elem_cnt--;
+  return found;
+}
+
+/* Calls ACTION for each element in hash table H in arbitrary
+   order.
+   Modifying hash table H while ohash_apply() is running, using
+   any of the functions ohash_clear(), ohash_destroy(),
+   ohash_insert(), ohash_replace(), or ohash_delete(), yields
+   undefined behavior, whether done from ACTION or elsewhere. */
+void ohash_apply(struct ohash* h, ohash_action_func* action) {
+  struct ohash_iterator i;
+
+  ASSERT(action != NULL);
+
+  ohash_first(&i, h);
+  while (ohash_next(&i))
+    action(ohash_cur(&i), h->aux);
+}
+
+/* Initializes I for iterating hash table H.
+
+   Iteration idiom:
+
+      struct ohash_iterator i;
+
+      ohash_first (&i, h);
+      while (ohash_next (&i))
+        {
+          struct foo *f = ohash_entry (ohash_cur (&i), struct foo, elem);
+          ...do something with f...
+        }
+
+   Modifying hash table H during iteration, using any of the
+   functions ohash_clear(), ohash_destroy(), ohash_insert(),
+   ohash_replace(), or ohash_delete(), invalidates all
+   iterators. */
+void ohash_first(struct ohash_iterator* i, struct ohash* h) {
+  ASSERT(i != NULL);
+  ASSERT(h != NULL);
+
+  i->hash = h;
+  i->idx = (size_t)-1;
+  i->elem = NULL;
+}
+
+/* Advances I to the next element in the hash table and returns
+   it.  Returns a null pointer if no elements are left.  Elements
+   are returned in arbitrary order.
+
+   The slots of `slots' are visited first, then those of
+   `old_slots', if any. */
+struct ohash_elem* ohash_next(struct ohash_iterator* i) {
+  struct ohash* h;
+
+  ASSERT(i != NULL);
+
+  h = i->hash;
+  for (;;) {
+    struct ohash_elem* e;
+
+    i->idx++;
+    if (i->idx < h->slot_cnt)
+      e = h->slots[i->idx].elem;
+    else if (i->idx - h->slot_cnt < h->old_slot_cnt)
+      e = h->old_slots[i->idx - h->slot_cnt].elem;
+    else {
+      i->idx = h->slot_cnt + h->old_slot_cnt;
+      i->elem = NULL;
+      break;
+    }
+
+    if (e != NULL && e != &moved) {
+      i->elem = e;
+      break;
+    }
+  }
+  return i->elem;
+}
+
+/* Returns the current element in the hash table iteration, or a
+   null pointer at the end of the table.  Undefined behavior
+   after calling ohash_first() but before ohash_next(). */
+struct ohash_elem* ohash_cur(struct ohash_iterator* i) {
+  return i->elem;
+}
+
+/* Returns the number of elements in H. */
+size_t ohash_size(struct ohash* h) { return h->elem_cnt; }
+
+/* Returns true if H contains no elements, false otherwise. */
+bool ohash_empty(struct ohash* h) { return h->elem_cnt == 0; }
+
+/* Computes E's hash value and caches it in E. */
+static void set_hash(struct ohash* h, struct ohash_elem* e) { e->hash = h->hash(e, h->aux); }
+
+/* Returns the slot in H that holds an element equal to E, which
+   must have its hash value set, or a null pointer if there is
+   none.  Looks in `slots' first and then in `old_slots'. */
+static struct ohash_slot* find_slot(struct ohash* h, struct ohash_elem* e) {
+  struct ohash_slot* slot = probe(h, h->slots, h->slot_cnt, e);
+  if (slot == NULL && h->old_slots != NULL)
+    slot = probe(h, h->old_slots, h->old_slot_cnt, e);
+  return slot;
+}
+
+/* Searches the SLOT_CNT SLOTS of H for an element equal to E,
+   starting from the slot E's hash value selects and stopping at
+   the first free slot.  Returns the slot if found or a null
+   pointer otherwise. */
+static struct ohash_slot* probe(struct ohash* h, struct ohash_slot* slots, size_t slot_cnt,
+                                struct ohash_elem* e) {
+  size_t mask = slot_cnt - 1;
+  size_t i;
+
+  for (i = e->hash & mask; slots[i].elem != NULL; i = (i + 1) & mask)
+    if (slots[i].hash == e->hash && slots[i].elem != &moved &&
+        h->equal(slots[i].elem, e, h->aux))
+      return &slots[i];
+  return NULL;
+}
+
+/* Puts E, whose hash value is HASH, into the first free slot at
+   or after the one HASH selects in `slots'.  There must be a
+   free slot. */
+static void add_slot(struct ohash* h, unsigned hash, struct ohash_elem* e) {
+  size_t mask = h->slot_cnt - 1;
+  size_t i;
+
+  ASSERT(h->used_cnt < h->slot_cnt);
+
+  for (i = hash & mask; h->slots[i].elem != NULL; i = (i + 1) & mask)
+    continue;
+  h->slots[i].hash = hash;
+  h->slots[i].elem = e;
+  h->used_cnt++;
+}
+
+/* Empties SLOT, which is in either `slots' or `old_slots' in
+   H. */
+static void remove_slot(struct ohash* h, struct ohash_slot* slot) {
+  size_t mask = h->slot_cnt - 1;
+  size_t i, j;
+
+  if (slot < h->slots || slot >= h->slots + h->slot_cnt) {
+    /* `old_slots' only ever empties, so a marker will do. */
+    slot->elem = &moved;
+    return;
+  }
+
+  /* Close the gap, so that no probe stops early at it: move
+     back each later element in the run that would still be
+     found from its home slot, then free the slot left over.
+     This is Knuth's Algorithm R (The Art of Computer
+     Programming, vol. 3, section 6.4). */
+  i = slot - h->slots;
+  for (j = (i + 1) & mask; h->slots[j].elem != NULL; j = (j + 1) & mask) {
+    size_t home = h->slots[j].hash & mask;
+
+    /* Leave the element at J if its home lies cyclically in
+       (I, J]. */
+    if (i <= j ? (i < home && home <= j) : (i < home || home <= j))
+      continue;
+    h->slots[i] = h->slots[j];
+    i = j;
+  }
+  h->slots[i].elem = NULL;
+  h->used_cnt--;
+}
+
+/* Makes sure that there is room in H for one more element
+   without letting `slots' get more than 3/4 full, starting to
+   grow the table if necessary.  If memory for a larger array is
+   not available, carries on with a fuller one, panicking only if
+   `slots' is completely full. */
+static void make_room(struct ohash* h) {
+  struct ohash_slot* new_slots;
+  size_t new_slot_cnt;
+
+  if ((h->used_cnt + 1) * 4 <= h->slot_cnt * 3)
+    return;
+
+  /* Finish off any earlier growth first.  With MOVE_CNT >= 2
+     this never has anything left to do. */
+  move_old(h, h->old_slot_cnt);
+
+  new_slot_cnt = h->slot_cnt * 2;
+  new_slots = calloc(new_slot_cnt, sizeof *new_slots);
+  if (new_slots == NULL) {
+    if (h->used_cnt + 1 < h->slot_cnt)
+      return;
+    PANIC("out of memory growing hash table");
+  }
+
+  h->old_slots = h->slots;
+  h->old_slot_cnt = h->slot_cnt;
+  h->old_idx = 0;
+  h->slots = new_slots;
+  h->slot_cnt = new_slot_cnt;
+  h->used_cnt = 0;
+}
+
+/* Moves the elements in up to CNT more slots of `old_slots' in H
+   into `slots', and frees `old_slots' once it has been
+   emptied. */
+static void move_old(struct ohash* h, size_t cnt) {
+  if (h->old_slots == NULL)
+    return;
+
+  for (; cnt > 0 && h->old_idx < h->old_slot_cnt; cnt--) {
+    struct ohash_slot* slot = &h->old_slots[h->old_idx++];
+    if (slot->elem != NULL && slot->elem != &moved) {
+      add_slot(h, slot->hash, slot->elem);
+      slot->elem = &moved;
+    }
+  }
+
+  if (h->old_idx >= h->old_slot_cnt) {
+    free(h->old_slots);
+    h->old_slots = NULL;
+    h->old_slot_cnt = 0;
+  }
+}
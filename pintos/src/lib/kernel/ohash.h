@@ -0,0 +1,104 @@
+#ifndef __LIB_KERNEL_OHASH_H
+#define __LIB_KERNEL_OHASH_H
+
+/* Open-addressing hash table.
+
+   An alternative to the chained table in hash.h, for tables that
+   are searched much more often than they are iterated.  Instead
+   of an array of lists, the table is a single array of slots.
+   Each slot holds a pointer to an element together with the
+   element's hash value, and collisions are resolved by linear
+   probing: an element lives in the first free slot at or after
+   the one its hash value selects.  A lookup thus reads a short
+   run of adjacent slots, comparing cached hash values, and calls
+   the equality function only on a hash match.
+
+   As with struct hash, elements are not allocated by the table.
+   Each structure that can be in an ohash embeds a struct
+   ohash_elem, and ohash_entry() converts a pointer to that
+   member back to a pointer to the structure.
+
+   The table keeps itself at most 3/4 full by doubling in size.
+   Growing does not move every element at once: the old array is
+   kept alongside the new one, and each later insertion or
+   deletion moves a few more of its elements across, so that no
+   single operation pays for a full rehash.  Lookups search both
+   arrays until the move is complete.  The table never shrinks. */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Open hash element. */
+struct ohash_elem {
+  unsigned hash; /* Hash value, set by the ohash functions. */
+};
+
+/* Converts pointer to open hash element OHASH_ELEM into a
+   pointer to the structure that OHASH_ELEM is embedded inside.
+   Supply the name of the outer structure STRUCT and the member
+   name MEMBER of the open hash element. */
+#define ohash_entry(OHASH_ELEM, STRUCT, MEMBER)                                                    \
+  ((STRUCT*)((uint8_t*)&(OHASH_ELEM)->hash - offsetof(STRUCT, MEMBER.hash)))
+
+/* Computes and returns the hash value for open hash element E,
+   given auxiliary data AUX. */
+typedef unsigned ohash_hash_func(const struct ohash_elem* e, void* aux);
+
+/* Returns true if open hash elements A and B are equal, given
+   auxiliary data AUX, and false otherwise. */
+typedef bool ohash_equal_func(const struct ohash_elem* a, const struct ohash_elem* b, void* aux);
+
+/* Performs some operation on open hash element E, given
+   auxiliary data AUX. */
+typedef void ohash_action_func(struct ohash_elem* e, void* aux);
+
+/* A slot in an open hash table. */
+struct ohash_slot {
+  unsigned hash;           /* Hash value of `elem'. */
+  struct ohash_elem* elem; /* Element, or a null pointer if free. */
+};
+
+/* Open hash table. */
+struct ohash {
+  size_t elem_cnt;              /* Number of elements in table. */
+  size_t slot_cnt;              /* Number of slots, a power of 2. */
+  size_t used_cnt;              /* Number of elements in `slots'. */
+  struct ohash_slot* slots;     /* Array of `slot_cnt' slots. */
+  struct ohash_slot* old_slots; /* Array being emptied, or null. */
+  size_t old_slot_cnt;          /* Number of slots in `old_slots'. */
+  size_t old_idx;               /* Next slot in `old_slots' to move. */
+  ohash_hash_func* hash;        /* Hash function. */
+  ohash_equal_func* equal;      /* Equality function. */
+  void* aux;                    /* Auxiliary data for `hash' and `equal'. */
+};
+
+/* An open hash table iterator. */
+struct ohash_iterator {
+  struct ohash* hash;      /* The hash table. */
+  size_t idx;              /* Index of the current slot. */
+  struct ohash_elem* elem; /* Current element. */
+};
+
+/* Basic life cycle. */
+bool ohash_init(struct ohash*, ohash_hash_func*, ohash_equal_func*, void* aux);
+void ohash_clear(struct ohash*, ohash_action_func*);
+void ohash_destroy(struct ohash*, ohash_action_func*);
+
+/* Search, insertion, deletion. */
+struct ohash_elem* ohash_insert(struct ohash*, struct ohash_elem*);
+struct ohash_elem* ohash_replace(struct ohash*, struct ohash_elem*);
+struct ohash_elem* ohash_find(struct ohash*, struct ohash_elem*);
+struct ohash_elem* ohash_delete(struct ohash*, struct ohash_elem*);
+
+/* Iteration. */
+void ohash_apply(struct ohash*, ohash_action_func*);
+void ohash_first(struct ohash_iterator*, struct ohash*);
+struct ohash_elem* ohash_next(struct ohash_iterator*);
+struct ohash_elem* ohash_cur(struct ohash_iterator*);
+
+/* Information. */
+size_t ohash_size(struct ohash*);
+bool ohash_empty(struct ohash*);
+
+#endif /* lib/kernel/ohash.h */
@@ -0,0 +1,341 @@
+/* Red-black tree.
+
+   See rbtree.h for basic information.  The algorithms follow
+   [CLRS] chapter 13, with null pointers in place of the
+   sentinel leaf, so the parent of a possibly null node is
+   tracked separately during removal. */
+
+#include "rbtree.h"
+#include "../debug.h"
+
+static void rotate_left(struct rb_tree*, struct rb_elem*);
+static void rotate_right(struct rb_tree*, struct rb_elem*);
+static void insert_fixup(struct rb_tree*, struct rb_elem*);
+static void remove_fixup(struct rb_tree*, struct rb_elem*, struct rb_elem* parent);
+static void transplant(struct rb_tree*, struct rb_elem* old, struct rb_elem* new);
+static struct rb_elem* subtree_min(struct rb_elem*);
+static struct rb_elem* subtree_max(struct rb_elem*);
+
+/* Returns true if E is a red node, false if it is black or
+   null. */
+static inline bool is_red(const struct rb_elem* e) { return e != NULL && e->red; }
+
+/* Initializes T as an empty tree ordered by LESS, given
+   auxiliary data AUX. */
+void rb_init(struct rb_tree* t, rb_less_func* less, void* aux) {
+  ASSERT(t != NULL);
+  ASSERT(less != NULL);
+
+  t->root = NULL;
+  t->size = 0;
+  t->less = less;
+  t->aux = aux;
+}
+
+/* Inserts E into T, after any elements equal to it. */
+void rb_insert(struct rb_tree* t, struct rb_elem* e) {
+  struct rb_elem* parent = NULL;
+  struct rb_elem** link = &t->root;
+
+  ASSERT(e != NULL);
+
+  while (*link != NULL) {
+    parent = *link;
+    link = t->less(e, parent, t->aux) ? &parent->left : &parent->right;
+  }
+
+  e->parent = parent;
+  e->left = e->right = NULL;
+  e->red = true;
+  *link = e;
+  t->size++;
+
+  insert_fixup(t, e);
+}
+
+/* Removes E, which must be in T, from T. */
+void rb_remove(struct rb_tree* t, struct rb_elem* e) {
+  struct rb_elem *child, *parent;
+  bool removed_red;
+
+  ASSERT(e != NULL);
+  ASSERT(t->size > 0);
+
+  if (e->left == NULL || e->right == NULL) {
+    /* E has at most one child, which takes its place. */
+    child = e->left != NULL ? e->left : e->right;
+    parent = e->parent;
+    removed_red = e->red;
+    transplant(t, e, child);
+  } else {
+    /* E's successor, which has no left child, takes its place
+       and color, so the color lost is the successor's. */
+    struct rb_elem* next = subtree_min(e->right);
+
+    child = next->right;
+    removed_red = next->red;
+    if (next->parent == e)
+      parent = next;
+    else {
+      parent = next->parent;
+      transplant(t, next, next->right);
+      next->right = e->right;
+      next->right->parent = next;
+    }
+    transplant(t, e, next);
+    next->left = e->left;
+    next->left->parent = next;
+    next->red = e->red;
+  }
+  t->size--;
+
+  if (!removed_red)
+    remove_fixup(t, child, parent);
+}
+
+/* Returns an element of T equal to KEY, or a null pointer if
+   there is none.  If several are equal to KEY, returns the first
+   of them. */
+struct rb_elem* rb_find(struct rb_tree* t, const struct rb_elem* key) {
+  struct rb_elem* e = rb_lower_bound(t, key);
+  return e != NULL && !t->less(key, e, t->aux) ? e : NULL;
+}
+
+/* Returns the first element of T that is not less than KEY, or a
+   null pointer if there is none. */
+struct rb_elem* rb_lower_bound(struct rb_tree* t, const struct rb_elem* key) {
+  struct rb_elem* bound = NULL;
+  struct rb_elem* e = t->root;
+
+  while (e != NULL)
+    if (!t->less(e, key, t->aux)) {
+      bound = e;
+      e = e->left;
+    } else
+      e = e->right;
+  return bound;
+}
+
+/* Returns the first element of T that is greater than KEY, or a
+   null pointer if there is none. */
+struct rb_elem* rb_upper_bound(struct rb_tree* t, const struct rb_elem* key) {
+  struct rb_elem* bound = NULL;
+  struct rb_elem* e = t->root;
+
+  while (e != NULL)
+    if (t->less(key, e, t->aux)) {
+      bound = e;
+      e = e->left;
+    } else
+      e = e->right;
+  return bound;
+}
+
+/* Returns the least element of T, or a null pointer if T is
+   empty. */
+struct rb_elem* rb_first(struct rb_tree* t) {
+  return t->root != NULL ? subtree_min(t->root) : NULL;
+}
+
+/* Returns the greatest element of T, or a null pointer if T is
+   empty. */
+struct rb_elem* rb_last(struct rb_tree* t) {
+  return t->root != NULL ? subtree_max(t->root) : NULL;
+}
+
+/* Returns the element after E in its tree, or a null pointer if
+   E is the last element. */
+struct rb_elem* rb_next(struct rb_elem* e) {
+  ASSERT(e != NULL);
+
+  if (e->right != NULL)
+    return subtree_min(e->right);
+  while (e->parent != NULL && e == e->parent->right)
+    e = e->parent;
+  return e->parent;
+}
+
+/* Returns the element before E in its tree, or a null pointer if
+   E is the first element. */
+struct rb_elem* rb_prev(struct rb_elem* e) {
+  ASSERT(e != NULL);
+
+  if (e->left != NULL)
+    return subtree_max(e->left);
+  while (e->parent != NULL && e == e->parent->left)
+    e = e->parent;
+  return e->parent;
+}
+
+/* Returns the number of elements in T. */
+size_t rb_size(struct rb_tree* t) { return t->size; }
+
+/* Returns true if T is empty, false otherwise. */
+bool rb_empty(struct rb_tree* t) { return t->root == NULL; }
+
+/* Makes E's right child take E's place, with E as its left
+   child. */
+static void rotate_left(struct rb_tree* t, struct rb_elem* e) {
+  struct rb_elem* r = e->right;
+
+  e->right = r->left;
+  if (r->left != NULL)
+    r->left->parent = e;
+  transplant(t, e, r);
+  r->left = e;
+  e->parent = r;
+}
+
+/* Makes E's left child take E's place, with E as its right
+   child. */
+static void rotate_right(struct rb_tree* t, struct rb_elem* e) {
+  struct rb_elem* l = e->left;
+
+  e->left = l->right;
+  if (l->right != NULL)
+    l->right->parent = e;
+  transplant(t, e, l);
+  l->right = e;
+  e->parent = l;
+}
+
+/* Restores the red-black properties after E, which is red, has
+   been added to T: no red node may have a red child, and the
+   root must be black. */
+static void insert_fixup(struct rb_tree* t, struct rb_elem* e) {
+  struct rb_elem* parent;
+
+  while (is_red(parent = e->parent)) {
+    /* A red node is never the root, so the grandparent exists. */
+    struct rb_elem* grandparent = parent->parent;
+
+    if (parent == grandparent->left) {
+      struct rb_elem* uncle = grandparent->right;
+      if (is_red(uncle)) {
+        /* Push the grandparent's blackness down a level and
+           carry on from the grandparent. */
+        parent->red = uncle->red = false;
+        grandparent->red = true;
+        e = grandparent;
+      } else {
+        if (e == parent->right) {
+          rotate_left(t, parent);
+          e = parent;
+          parent = e->parent;
+        }
+        parent->red = false;
+        grandparent->red = true;
+        rotate_right(t, grandparent);
+      }
+    } else {
+      struct rb_elem* uncle = grandparent->left;
+      if (is_red(uncle)) {
+        parent->red = uncle->red = false;
+        grandparent->red = true;
+        e = grandparent;
+      } else {
+        if (e == parent->left) {
+          rotate_right(t, parent);
+          e = parent;
+          parent = e->parent;
+        }
+        parent->red = false;
+        grandparent->red = true;
+        rotate_left(t, grandparent);
+      }
+    }
+  }
+  t->root->red = false;
+}
+
+/* Restores the red-black properties after a black node has been
+   removed from T and replaced by E, which may be null, as a
+   child of PARENT.  Paths through E are one black node short. */
+static void remove_fixup(struct rb_tree* t, struct rb_elem* e, struct rb_elem* parent) {
+  while (e != t->root && !is_red(e)) {
+    /* E is one black node short of its sibling, so the sibling
+       exists. */
+    if (e == parent->left) {
+      struct rb_elem* sibling = parent->right;
+      if (sibling->red) {
+        sibling->red = false;
+        parent->red = true;
+        rotate_left(t, parent);
+        sibling = parent->right;
+      }
+      if (!is_red(sibling->left) && !is_red(sibling->right)) {
+        /* Take a black from the sibling's side too and move the
+           shortfall up to the parent. */
+        sibling->red = true;
+        e = parent;
+        parent = e->parent;
+      } else {
+        if (!is_red(sibling->right)) {
+          sibling->left->red = false;
+          sibling->red = true;
+          rotate_right(t, sibling);
+          sibling = parent->right;
+        }
+        sibling->red = parent->red;
+        parent->red = false;
+        sibling->right->red = false;
+        rotate_left(t, parent);
+        e = t->root;
+      }
+    } else {
+      struct rb_elem* sibling = parent->left;
+      if (sibling->red) {
+        sibling->red = false;
+        parent->red = true;
+        rotate_right(t, parent);
+        sibling = parent->left;
+      }
+      if (!is_red(sibling->left) && !is_red(sibling->right)) {
+        sibling->red = true;
+        e = parent;
+        parent = e->parent;
+      } else {
+        if (!is_red(sibling->left)) {
+          sibling->right->red = false;
+          sibling->red = true;
+          rotate_left(t, sibling);
+          sibling = parent->left;
+        }
+        sibling->red = parent->red;
+        parent->red = false;
+        sibling->left->red = false;
+        rotate_right(t, parent);
+        e = t->root;
+      }
+    }
+  }
+  if (e != NULL)
+    e->red = false;
+}
+
+/* Puts NEW, which may be null, in OLD's place under OLD's parent
+   in T.  OLD's own links are left alone. */
+static void transplant(struct rb_tree* t, struct rb_elem* old, struct rb_elem* new) {
+  if (old->parent == NULL)
+    t->root = new;
+  else if (old == old->parent->left)
+    old->parent->left = new;
+  else
+    old->parent->right = new;
+  if (new != NULL)
+    new->parent = old->parent;
+}
+
+/* Returns the least element in the subtree rooted at E. */
+static struct rb_elem* subtree_min(struct rb_elem* e) {
+  while (e->left != NULL)
+    e = e->left;
+  return e;
+}
+
+/* Returns the greatest element in the subtree rooted at E. */
+static struct rb_elem* subtree_max(struct rb_elem* e) {
+  while (e->right != NULL)
+    e = e->right;
+  return e;
+}
@@ -0,0 +1,110 @@
+#ifndef __LIB_KERNEL_RBTREE_H
+#define __LIB_KERNEL_RBTREE_H
+
+/* Red-black tree.
+
+   A balanced binary search tree that keeps its elements in the
+   order defined by a caller-supplied comparison function, for
+   uses that lists serve poorly: insertion and removal take
+   O(lg n) time instead of O(n) for list_insert_ordered(), and so
+   do finding an element and finding the first element not less
+   than a given key.  Elements may compare equal; an element is
+   inserted after any equal elements already in the tree.
+
+   Like lists and hash tables, trees do not allocate memory.  Each
+   structure that can be in a tree embeds a struct rb_elem member,
+   and rb_entry() converts a pointer to that member back to a
+   pointer to the structure.  For example:
+
+      struct foo
+        {
+          struct rb_elem elem;
+          int64_t key;
+          ...other members...
+        };
+
+      static bool
+      foo_less (const struct rb_elem *a, const struct rb_elem *b,
+                void *aux UNUSED)
+      {
+        return (rb_entry (a, struct foo, elem)->key
+                < rb_entry (b, struct foo, elem)->key);
+      }
+
+      struct rb_tree foo_tree;
+
+      rb_init (&foo_tree, foo_less, NULL);
+
+   Iteration runs from rb_first() (or rb_last()) with rb_next()
+   (or rb_prev()), which return a null pointer past the end:
+
+      struct rb_elem *e;
+
+      for (e = rb_first (&foo_tree); e != NULL; e = rb_next (e))
+        {
+          struct foo *f = rb_entry (e, struct foo, elem);
+          ...do something with f...
+        }
+
+   Searches take a key in the form of an element.  Fill in just
+   the members that the comparison function looks at in a struct
+   foo, typically a local variable, and pass its `elem'.
+
+   An element's key must not change while the element is in a
+   tree.  Remove it, change the key, and insert it again. */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Red-black tree element. */
+struct rb_elem {
+  struct rb_elem* parent; /* Parent, or null for the root. */
+  struct rb_elem* left;   /* Left child, or null. */
+  struct rb_elem* right;  /* Right child, or null. */
+  bool red;               /* Red or black? */
+};
+
+/* Converts pointer to tree element RB_ELEM into a pointer to the
+   structure that RB_ELEM is embedded inside.  Supply the name of
+   the outer structure STRUCT and the member name MEMBER of the
+   tree element.  See the big comment at the top of the file for
+   an example. */
+#define rb_entry(RB_ELEM, STRUCT, MEMBER)                                                          \
+  ((STRUCT*)((uint8_t*)&(RB_ELEM)->parent - offsetof(STRUCT, MEMBER.parent)))
+
+/* Compares the value of two tree elements A and B, given
+   auxiliary data AUX.  Returns true if A is less than B, or
+   false if A is greater than or equal to B. */
+typedef bool rb_less_func(const struct rb_elem* a, const struct rb_elem* b, void* aux);
+
+/* Red-black tree. */
+struct rb_tree {
+  struct rb_elem* root; /* Root, or null if empty. */
+  size_t size;          /* Number of elements. */
+  rb_less_func* less;   /* Comparison function. */
+  void* aux;            /* Auxiliary data for `less'. */
+};
+
+void rb_init(struct rb_tree*, rb_less_func*, void* aux);
+
+/* Insertion and removal. */
+void rb_insert(struct rb_tree*, struct rb_elem*);
+void rb_remove(struct rb_tree*, struct rb_elem*);
+
+/* Search. */
+struct rb_elem* rb_find(struct rb_tree*, const struct rb_elem* key);
+struct rb_elem* rb_lower_bound(struct rb_tree*, const struct rb_elem* key);
+struct rb_elem* rb_upper_bound(struct rb_tree*, const struct rb_elem* key);
+
+/* Traversal. */
+struct rb_elem* rb_first(struct rb_tree*);
+struct rb_elem* rb_last(struct rb_tree*);
+struct rb_elem* rb_next(struct rb_elem*);
+struct rb_elem* rb_prev(struct rb_elem*);
+
+/* Properties. */
+size_t rb_size(struct rb_tree*);
+bool rb_empty(struct rb_tree*);
+
+#endif /* lib/kernel/rbtree.h */
@@ -1,5 +1,21 @@
 #include <string.h>
 #include <debug.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Blocks at least this long are moved a 32-bit word at a time,
+   after aligning the destination.  Shorter ones are moved a byte
+   at a time, where the setup would cost more than it saves. */
+#define WORD_MIN 16
+
+/* A 32-bit word that may alias any other type, for reading and
+   writing blocks of bytes a word at a time. */
+typedef uint32_t __attribute__((__may_alias__)) word_t;
+
+static void split_block(uintptr_t edge, size_t size, bool down, size_t* head, size_t* words,
+                        size_t* rest);
+static void copy_up(unsigned char*, const unsigned char*, size_t);
+static void copy_down(unsigned char*, const unsigned char*, size_t);
 
 /* Copies SIZE bytes from SRC to DST, which must not overlap.
    Returns DST. */
@@ -10,8 +26,7 @@ void* memcpy(void* dst_, const void* src_, size_t size) {
   ASSERT(dst != NULL || size == 0);
   ASSERT(src != NULL || size == 0);
 
-  while (size-- > 0)
-    *dst++ = *src++;
+  copy_up(dst, src, size);
 
   return dst_;
 }
@@ -25,17 +40,63 @@ void* memmove(void* dst_, const void* src_, size_t size) {
   ASSERT(dst != NULL || size == 0);
   ASSERT(src != NULL || size == 0);
 
-  if (dst < src) {
-    while (size-- > 0)
-      *dst++ = *src++;
+  if (dst <= src || dst >= src + size)
+    copy_up(dst, src, size);
+  else
+    copy_down(dst, src, size);
+
+  return dst_;
+}
+
+/* Splits a SIZE-byte block starting or ending at address EDGE
+   into *HEAD bytes up to the nearest word boundary, then *WORDS
+   32-bit words, then *REST bytes.  With DOWN false, EDGE is the
+   block's first byte and the boundary is above it; with DOWN
+   true, EDGE is just past its last byte and the boundary is
+   below it.  Short blocks are all head. */
+static void split_block(uintptr_t edge, size_t size, bool down, size_t* head, size_t* words,
+                        size_t* rest) {
+  if (size < WORD_MIN) {
+    *head = size;
+    *words = *rest = 0;
   } else {
-    dst += size;
-    src += size;
-    while (size-- > 0)
-      *--dst = *--src;
+    *head = (down ? edge : -edge) & 3;
+    *words = (size - *head) / 4;
+    *rest = (size - *head) % 4;
   }
+}
 
-  return dst;
+/* Copies SIZE bytes from SRC to DST in ascending order of
+   address: bytes up to a word boundary in DST, then words, then
+   the bytes left over.  When DST is word-aligned, as for page
+   copies, the whole block goes through one `rep movsl'. */
+static void copy_up(unsigned char* dst, const unsigned char* src, size_t size) {
+  size_t head, words, rest;
+
+  split_block((uintptr_t)dst, size, false, &head, &words, &rest);
+  asm volatile("rep movsb; movl %[words], %%ecx; rep movsl; movl %[rest], %%ecx; rep movsb"
+               : "+D"(dst), "+S"(src), "+c"(head)
+               : [words] "g"(words), [rest] "g"(rest)
+               : "memory");
+}
+
+/* Copies SIZE bytes from SRC to DST in descending order of
+   address, for overlapping blocks with DST above SRC.  Works
+   like copy_up() from the end of the blocks.  The direction flag
+   is set only for the duration of the copy, and interrupt
+   handlers clear it on entry. */
+static void copy_down(unsigned char* dst, const unsigned char* src, size_t size) {
+  size_t head, words, rest;
+
+  split_block((uintptr_t)(dst + size), size, true, &head, &words, &rest);
+  dst += size - 1;
+  src += size - 1;
+  asm volatile("std; rep movsb; "
+               "subl $3, %%edi; subl $3, %%esi; movl %[words], %%ecx; rep movsl; "
+               "addl $3, %%edi; addl $3, %%esi; movl %[rest], %%ecx; rep movsb; cld"
+               : "+D"(dst), "+S"(src), "+c"(head)
+               : [words] "g"(words), [rest] "g"(rest)
+               : "memory");
 }
 
 /* Find the first differing byte in the two blocks of SIZE bytes
@@ -49,6 +110,13 @@ int memcmp(const void* a_, const void* b_, size_t size) {
   ASSERT(a != NULL || size == 0);
   ASSERT(b != NULL || size == 0);
 
+  /* Skip equal words, then find the differing byte, if any, in
+     the word that stopped the scan or in the bytes after the
+     last whole word.  x86 allows unaligned word loads. */
+  for (; size >= 4 && *(const word_t*)a == *(const word_t*)b; size -= 4) {
+    a += 4;
+    b += 4;
+  }
   for (; size-- > 0; a++, b++)
     if (*a != *b)
       return *a > *b ? +1 : -1;
@@ -244,11 +312,17 @@ char* strtok_r(char* s, const char* delimiters, char** save_ptr) {
 /* Sets the SIZE bytes in DST to VALUE. */
 void* memset(void* dst_, int value, size_t size) {
   unsigned char* dst = dst_;
+  size_t head, words, rest;
 
   ASSERT(dst != NULL || size == 0);
 
-  while (size-- > 0)
-    *dst++ = value;
+  /* Same strategy as copy_up(), storing VALUE in every byte of
+     EAX. */
+  split_block((uintptr_t)dst, size, false, &head, &words, &rest);
+  asm volatile("rep stosb; movl %[words], %%ecx; rep stosl; movl %[rest], %%ecx; rep stosb"
+               : "+D"(dst), "+c"(head)
+               : "a"((unsigned char)value * 0x01010101u), [words] "g"(words), [rest] "g"(rest)
+               : "memory");
 
   return dst_;
 }
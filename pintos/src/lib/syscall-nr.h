@@ -28,7 +28,11 @@ enum {
   SYS_MKDIR,   /* Create a directory. */
   SYS_READDIR, /* Reads a directory entry. */
   SYS_ISDIR,   /* Tests if a fd represents a directory. */
-  SYS_INUMBER  /* Returns the inode number for a fd. */
+  SYS_INUMBER, /* Returns the inode number for a fd. */
+
+  /* Extensions. */
+  SYS_CLOCK, /* Reads the high-resolution clock. */
+  SYS_SBRK   /* Moves the end of the heap. */
 };
 
 #endif /* lib/syscall-nr.h */
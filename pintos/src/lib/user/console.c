@@ -3,6 +3,37 @@
 #include <syscall.h>
 #include <syscall-nr.h>
 
+/* A buffered output stream.
+
+   Every write() is a system call, which costs far more than
+   copying a few bytes, so output to the standard output handle
+   collects in a buffer and goes out in as few write() calls as
+   the buffering mode allows.  The standard output handle is
+   always the console, so it is line buffered by default, which
+   keeps whole lines together and in order with output from
+   other processes.  hsetvbuf() selects full buffering or no
+   buffering instead.
+
+   exit() and halt() flush the buffer, and read() from the
+   standard input handle flushes it first so that a prompt
+   without a new-line appears before the program waits for
+   input. */
+struct stream {
+  int handle;  /* Output file handle. */
+  int mode;    /* _IOFBF, _IOLBF, or _IONBF. */
+  char* buf;   /* Buffer. */
+  size_t size; /* Capacity of `buf'. */
+  size_t len;  /* Number of bytes in `buf'. */
+};
+
+static char stdout_buf[BUFSIZ];
+static struct stream stdout_stream = {STDOUT_FILENO, _IOLBF, stdout_buf, sizeof stdout_buf, 0};
+
+static struct stream* get_stream(int handle);
+static void stream_write(struct stream*, const void*, size_t);
+static void stream_putc(struct stream*, char);
+static void stream_flush(struct stream*);
+
 /* The standard vprintf() function,
    which is like printf() but uses a va_list. */
 int vprintf(const char* format, va_list args) { return vhprintf(STDOUT_FILENO, format, args); }
@@ -22,19 +53,63 @@ int hprintf(int handle, const char* format, ...) {
 /* Writes string S to the console, followed by a new-line
    character. */
 int puts(const char* s) {
-  write(STDOUT_FILENO, s, strlen(s));
-  putchar('\n');
+  stream_write(&stdout_stream, s, strlen(s));
+  stream_putc(&stdout_stream, '\n');
 
   return 0;
 }
 
 /* Writes C to the console. */
 int putchar(int c) {
-  char c2 = c;
-  write(STDOUT_FILENO, &c2, 1);
+  stream_putc(&stdout_stream, c);
   return c;
 }
 
+/* Writes the SIZE bytes in BUFFER to HANDLE, through HANDLE's
+   buffer if it has one, and returns SIZE, or the value returned
+   by write() if HANDLE is unbuffered. */
+int hwrite(int handle, const void* buffer, size_t size) {
+  struct stream* s = get_stream(handle);
+
+  if (s == NULL)
+    return write(handle, buffer, size);
+  stream_write(s, buffer, size);
+  return size;
+}
+
+/* Writes out any output buffered for HANDLE.  Returns 0. */
+int hflush(int handle) {
+  struct stream* s = get_stream(handle);
+
+  if (s != NULL)
+    stream_flush(s);
+  return 0;
+}
+
+/* Sets the buffering MODE for HANDLE to _IOFBF, _IOLBF, or
+   _IONBF, using the SIZE bytes in BUF as the buffer, or the
+   default buffer, limited to SIZE bytes if SIZE is nonzero, if
+   BUF is a null pointer.  Output already buffered is written
+   out first.  Returns 0 if successful, -1 if HANDLE cannot be
+   buffered or MODE is invalid. */
+int hsetvbuf(int handle, char* buf, int mode, size_t size) {
+  struct stream* s = get_stream(handle);
+
+  if (s == NULL || (mode != _IOFBF && mode != _IOLBF && mode != _IONBF))
+    return -1;
+
+  stream_flush(s);
+  if (buf == NULL || size == 0) {
+    buf = stdout_buf;
+    if (size == 0 || size > sizeof stdout_buf)
+      size = sizeof stdout_buf;
+  }
+  s->mode = mode;
+  s->buf = buf;
+  s->size = size;
+  return 0;
+}
+
 /* Auxiliary data for vhprintf_helper(). */
 struct vhprintf_aux {
   char buf[64]; /* Character buffer. */
@@ -44,6 +119,7 @@ struct vhprintf_aux {
 };
 
 static void add_char(char, void*);
+static void add_stream_char(char, void*);
 static void flush(struct vhprintf_aux*);
 
 /* Formats the printf() format specification FORMAT with
@@ -54,8 +130,12 @@ int vhprintf(int handle, const char* format, va_list args) {
   aux.p = aux.buf;
   aux.char_cnt = 0;
   aux.handle = handle;
-  __vprintf(format, args, add_char, &aux);
-  flush(&aux);
+  if (get_stream(handle) != NULL)
+    __vprintf(format, args, add_stream_char, &aux);
+  else {
+    __vprintf(format, args, add_char, &aux);
+    flush(&aux);
+  }
   return aux.char_cnt;
 }
 
@@ -69,9 +149,55 @@ static void add_char(char c, void* aux_) {
   aux->char_cnt++;
 }
 
+/* Adds C to the stream for the handle in AUX. */
+static void add_stream_char(char c, void* aux_) {
+  struct vhprintf_aux* aux = aux_;
+  stream_putc(get_stream(aux->handle), c);
+  aux->char_cnt++;
+}
+
 /* Flushes the buffer in AUX. */
 static void flush(struct vhprintf_aux* aux) {
   if (aux->p > aux->buf)
     write(aux->handle, aux->buf, aux->p - aux->buf);
   aux->p = aux->buf;
 }
+
+/* Returns the buffered stream for HANDLE, or a null pointer if
+   HANDLE is not buffered. */
+static struct stream* get_stream(int handle) {
+  return handle == STDOUT_FILENO ? &stdout_stream : NULL;
+}
+
+/* Appends the SIZE bytes in BUFFER to S, writing out S's buffer
+   as its mode requires.  Data too big for the buffer is written
+   directly. */
+static void stream_write(struct stream* s, const void* buffer, size_t size) {
+  if (s->mode == _IONBF || s->len + size > s->size) {
+    stream_flush(s);
+    if (s->mode == _IONBF || size >= s->size) {
+      write(s->handle, buffer, size);
+      return;
+    }
+  }
+
+  memcpy(s->buf + s->len, buffer, size);
+  s->len += size;
+  if (s->mode == _IOLBF && memchr(buffer, '\n', size) != NULL)
+    stream_flush(s);
+}
+
+/* Appends C to S, writing out S's buffer as its mode
+   requires. */
+static void stream_putc(struct stream* s, char c) {
+  s->buf[s->len++] = c;
+  if (s->mode == _IONBF || (s->mode == _IOLBF && c == '\n') || s->len >= s->size)
+    stream_flush(s);
+}
+
+/* Writes out the contents of S's buffer. */
+static void stream_flush(struct stream* s) {
+  if (s->len > 0)
+    write(s->handle, s->buf, s->len);
+  s->len = 0;
+}
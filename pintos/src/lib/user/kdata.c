@@ -0,0 +1,39 @@
+#include <kdata.h>
+#include <syscall.h>
+
+/* The kernel data pages, which the kernel maps read-only into
+   every process.  See lib/kdata.h.  The system-wide page changes
+   underneath us on every timer tick, hence `volatile'. */
+static const volatile struct kdata* const kdata = KDATA_ADDR;
+static const struct kdata_proc* const kdata_proc = KDATA_PROC_ADDR;
+
+/* Returns the number of timer ticks since the OS booted. */
+int64_t get_ticks(void) {
+  uint32_t seq;
+  int64_t ticks;
+
+  /* The two halves of `ticks' are read separately, so read them
+     again if a tick came in between. */
+  do {
+    seq = kdata->seq;
+    ticks = kdata->ticks;
+  } while (seq != kdata->seq);
+  return ticks;
+}
+
+/* Returns the number of timer ticks per second. */
+int get_timer_freq(void) { return kdata->timer_freq; }
+
+/* Returns 100 times the system load average. */
+int get_load_avg(void) { return kdata->load_avg; }
+
+/* Returns the time at which the OS booted, in seconds since the
+   Unix epoch. */
+uint32_t get_boot_time(void) { return kdata->boot_time; }
+
+/* Returns the process identifier of the running process. */
+pid_t getpid(void) { return kdata_proc->pid; }
+
+/* Returns the process identifier of the process that started the
+   running process. */
+pid_t getppid(void) { return kdata_proc->ppid; }
@@ -0,0 +1,379 @@
+#include <debug.h>
+#include <round.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syscall.h>
+
+/* A simple implementation of malloc() for user programs.
+
+   This follows the kernel's allocator in threads/malloc.c.  The
+   size of each request, in bytes, is rounded up to a power of 2
+   and assigned to the "descriptor" that manages blocks of that
+   size.  The descriptor keeps a list of free blocks.  If the
+   free list is nonempty, one of its blocks is used to satisfy
+   the request.  Otherwise, a new page, called an "arena", is
+   divided into blocks, all of which are added to the
+   descriptor's free list.  Blocks bigger than 1 kB get runs of
+   contiguous pages of their own, with the number of pages in
+   the arena header at the start of the run.
+
+   Pages come from the heap, which sbrk() grows at the top.
+   Unlike the kernel's page allocator, sbrk() can only give back
+   pages at the top of the heap, so freed pages go on a list of
+   free runs, in address order with adjacent runs merged, from
+   which later requests are served first-fit.  Only when a large
+   enough free run reaches the top of the heap is it returned
+   with sbrk().
+
+   When the last block in use in an arena is freed, the arena's
+   page is freed too, unless it holds the descriptor's only free
+   blocks, in which case it is kept so that a program that
+   repeatedly allocates and frees a single block does not carve
+   up a fresh page each time. */
+
+/* Size of a page. */
+#define PAGE_SIZE 4096
+
+/* Free pages at the top of the heap are returned with sbrk() once
+   there are at least this many. */
+#define TRIM_PAGES 16
+
+/* Free block. */
+struct block {
+  struct block* prev; /* Previous free block in list. */
+  struct block* next; /* Next free block in list. */
+};
+
+/* Descriptor. */
+struct desc {
+  size_t block_size;       /* Size of each element in bytes. */
+  size_t blocks_per_arena; /* Number of blocks in an arena. */
+  size_t free_cnt;         /* Number of blocks in free list. */
+  struct block* free_list; /* List of free blocks. */
+};
+
+/* Magic number for detecting arena corruption. */
+#define ARENA_MAGIC 0x9a548eed
+
+/* Arena. */
+struct arena {
+  unsigned magic;    /* Always set to ARENA_MAGIC. */
+  struct desc* desc; /* Owning descriptor, null for big block. */
+  size_t free_cnt;   /* Free blocks; pages in big block. */
+};
+
+/* A run of free pages. */
+struct run {
+  struct run* next; /* Next run, at a higher address. */
+  size_t page_cnt;  /* Number of pages in this run. */
+};
+
+/* Our set of descriptors, for blocks of 16 bytes to 1 kB. */
+static struct desc descs[7];
+static size_t desc_cnt;
+
+/* Free runs of pages, in order of increasing address. */
+static struct run* free_runs;
+
+static void init_descs(void);
+static void* get_pages(size_t page_cnt);
+static void free_pages(void* pages, size_t page_cnt);
+static void push_block(struct desc*, struct block*);
+static void remove_block(struct desc*, struct block*);
+static struct arena* block_to_arena(struct block*);
+static struct block* arena_to_block(struct arena*, size_t idx);
+
+/* Obtains and returns a new block of at least SIZE bytes.
+   Returns a null pointer if memory is not available. */
+void* malloc(size_t size) {
+  struct desc* d;
+  struct block* b;
+  struct arena* a;
+
+  /* A null pointer satisfies a request for 0 bytes. */
+  if (size == 0)
+    return NULL;
+
+  /* Find the smallest descriptor that satisfies a SIZE-byte
+     request. */
+  if (desc_cnt == 0)
+    init_descs();
+  for (d = descs; d < descs + desc_cnt; d++)
+    if (d->block_size >= size)
+      break;
+  if (d == descs + desc_cnt) {
+    /* SIZE is too big for any descriptor.
+       Allocate enough pages to hold SIZE plus an arena. */
+    size_t page_cnt;
+
+    if (size > SIZE_MAX - sizeof *a - PAGE_SIZE)
+      return NULL;
+    page_cnt = DIV_ROUND_UP(size + sizeof *a, PAGE_SIZE);
+    a = get_pages(page_cnt);
+    if (a == NULL)
+      return NULL;
+
+    /* Initialize the arena to indicate a big block of PAGE_CNT
+       pages, and return it. */
+    a->magic = ARENA_MAGIC;
+    a->desc = NULL;
+    a->free_cnt = page_cnt;
+    return a + 1;
+  }
+
+  /* If the free list is empty, create a new arena. */
+  if (d->free_list == NULL) {
+    size_t i;
+
+    a = get_pages(1);
+    if (a == NULL)
+      return NULL;
+
+    /* Initialize arena and add its blocks to the free list. */
+    a->magic = ARENA_MAGIC;
+    a->desc = d;
+    a->free_cnt = d->blocks_per_arena;
+    for (i = d->blocks_per_arena; i-- > 0;)
+      push_block(d, arena_to_block(a, i));
+  }
+
+  /* Get a block from free list and return it. */
+  b = d->free_list;
+  remove_block(d, b);
+  a = block_to_arena(b);
+  a->free_cnt--;
+  return b;
+}
+
+/* Allocates and return A times B bytes initialized to zeroes.
+   Returns a null pointer if memory is not available. */
+void* calloc(size_t a, size_t b) {
+  void* p;
+  size_t size;
+
+  /* Calculate block size and make sure it fits in size_t. */
+  if (b != 0 && a > SIZE_MAX / b)
+    return NULL;
+  size = a * b;
+
+  /* Allocate and zero memory. */
+  p = malloc(size);
+  if (p != NULL)
+    memset(p, 0, size);
+
+  return p;
+}
+
+/* Returns the number of bytes allocated for BLOCK. */
+static size_t block_size(void* block) {
+  struct block* b = block;
+  struct arena* a = block_to_arena(b);
+  struct desc* d = a->desc;
+
+  return d != NULL ? d->block_size : PAGE_SIZE * a->free_cnt - sizeof *a;
+}
+
+/* Attempts to resize OLD_BLOCK to NEW_SIZE bytes, possibly
+   moving it in the process.
+   If successful, returns the new block; on failure, returns a
+   null pointer.
+   A call with null OLD_BLOCK is equivalent to malloc(NEW_SIZE).
+   A call with zero NEW_SIZE is equivalent to free(OLD_BLOCK). */
+void* realloc(void* old_block, size_t new_size) {
+  if (new_size == 0) {
+    free(old_block);
+    return NULL;
+  } else if (old_block != NULL && new_size <= block_size(old_block)) {
+    /* It already fits. */
+    return old_block;
+  } else {
+    void* new_block = malloc(new_size);
+    if (old_block != NULL && new_block != NULL) {
+      size_t old_size = block_size(old_block);
+      size_t min_size = new_size < old_size ? new_size : old_size;
+      memcpy(new_block, old_block, min_size);
+      free(old_block);
+    }
+    return new_block;
+  }
+}
+
+/* Frees block P, which must have been previously allocated with
+   malloc(), calloc(), or realloc(). */
+void free(void* p) {
+  if (p != NULL) {
+    struct block* b = p;
+    struct arena* a = block_to_arena(b);
+    struct desc* d = a->desc;
+
+    if (d != NULL) {
+      /* It's a normal block.  We handle it here. */
+
+#ifndef NDEBUG
+      /* Clear the block to help detect use-after-free bugs. */
+      memset(b, 0xcc, d->block_size);
+#endif
+
+      /* Add block to free list. */
+      push_block(d, b);
+
+      /* If the arena is now entirely unused, and other arenas
+         have free blocks, free it. */
+      if (++a->free_cnt >= d->blocks_per_arena && d->free_cnt > d->blocks_per_arena) {
+        size_t i;
+
+        ASSERT(a->free_cnt == d->blocks_per_arena);
+        for (i = 0; i < d->blocks_per_arena; i++)
+          remove_block(d, arena_to_block(a, i));
+        free_pages(a, 1);
+      }
+    } else {
+      /* It's a big block.  Free its pages. */
+      free_pages(a, a->free_cnt);
+    }
+  }
+}
+
+/* Initializes the malloc() descriptors. */
+static void init_descs(void) {
+  size_t block_size;
+
+  for (block_size = 16; block_size < PAGE_SIZE / 2; block_size *= 2) {
+    struct desc* d = &descs[desc_cnt++];
+    ASSERT(desc_cnt <= sizeof descs / sizeof *descs);
+    d->block_size = block_size;
+    d->blocks_per_arena = (PAGE_SIZE - sizeof(struct arena)) / block_size;
+    d->free_cnt = 0;
+    d->free_list = NULL;
+  }
+}
+
+/* Obtains and returns PAGE_CNT contiguous pages, from a free run
+   if one is big enough, otherwise from the top of the heap.
+   Returns a null pointer if memory is not available. */
+static void* get_pages(size_t page_cnt) {
+  struct run **rp, *r;
+  uint8_t* top;
+  size_t need;
+
+  /* First fit from the free runs. */
+  for (rp = &free_runs; (r = *rp) != NULL; rp = &r->next)
+    if (r->page_cnt >= page_cnt) {
+      if (r->page_cnt == page_cnt)
+        *rp = r->next;
+      else {
+        struct run* rest = (struct run*)((uint8_t*)r + page_cnt * PAGE_SIZE);
+        rest->next = r->next;
+        rest->page_cnt = r->page_cnt - page_cnt;
+        *rp = rest;
+      }
+      return r;
+    }
+
+  /* Grow the heap.  If the last free run is at the top of the
+     heap, it makes up part of the new pages. */
+  top = sbrk(0);
+  if (top == (void*)-1)
+    return NULL;
+  need = page_cnt;
+  r = NULL;
+  if (free_runs != NULL) {
+    for (rp = &free_runs; (*rp)->next != NULL; rp = &(*rp)->next)
+      continue;
+    if ((uint8_t*)*rp + (*rp)->page_cnt * PAGE_SIZE == top) {
+      r = *rp;
+      need -= r->page_cnt;
+    }
+  }
+  if (need > (INTPTR_MAX - PAGE_SIZE) / PAGE_SIZE ||
+      sbrk(ROUND_UP((uintptr_t)top, PAGE_SIZE) - (uintptr_t)top + need * PAGE_SIZE) == (void*)-1)
+    return NULL;
+
+  if (r != NULL) {
+    *rp = NULL;
+    return r;
+  }
+  return (void*)ROUND_UP((uintptr_t)top, PAGE_SIZE);
+}
+
+/* Frees the PAGE_CNT pages starting at PAGES, merging them with
+   neighboring free runs, and returns them to the system if they
+   end up in a large enough run at the top of the heap. */
+static void free_pages(void* pages, size_t page_cnt) {
+  struct run* r = pages;
+  struct run **rp, *prev = NULL;
+
+  /* Find the runs before and after R. */
+  for (rp = &free_runs; *rp != NULL && *rp < r; rp = &(*rp)->next)
+    prev = *rp;
+
+  /* Insert R, merging it with the run after it if they touch. */
+  r->page_cnt = page_cnt;
+  r->next = *rp;
+  if (r->next != NULL && (uint8_t*)r + r->page_cnt * PAGE_SIZE == (uint8_t*)r->next) {
+    r->page_cnt += r->next->page_cnt;
+    r->next = r->next->next;
+  }
+  *rp = r;
+
+  /* Merge R into the run before it if they touch. */
+  if (prev != NULL && (uint8_t*)prev + prev->page_cnt * PAGE_SIZE == (uint8_t*)r) {
+    prev->page_cnt += r->page_cnt;
+    prev->next = r->next;
+    r = prev;
+  }
+
+  /* Trim the top of the heap. */
+  if (r->next == NULL && r->page_cnt >= TRIM_PAGES &&
+      (uint8_t*)r + r->page_cnt * PAGE_SIZE == sbrk(0)) {
+    for (rp = &free_runs; *rp != r; rp = &(*rp)->next)
+      continue;
+    *rp = NULL;
+    sbrk(-(intptr_t)(r->page_cnt * PAGE_SIZE));
+  }
+}
+
+/* Adds B to the front of D's free list. */
+static void push_block(struct desc* d, struct block* b) {
+  b->prev = NULL;
+  b->next = d->free_list;
+  if (b->next != NULL)
+    b->next->prev = b;
+  d->free_list = b;
+  d->free_cnt++;
+}
+
+/* Removes B from D's free list. */
+static void remove_block(struct desc* d, struct block* b) {
+  if (b->prev != NULL)
+    b->prev->next = b->next;
+  else
+    d->free_list = b->next;
+  if (b->next != NULL)
+    b->next->prev = b->prev;
+  d->free_cnt--;
+}
+
+/* Returns the arena that block B is inside. */
+static struct arena* block_to_arena(struct block* b) {
+  struct arena* a = (struct arena*)ROUND_DOWN((uintptr_t)b, PAGE_SIZE);
+
+  /* Check that the arena is valid. */
+  ASSERT(a != NULL);
+  ASSERT(a->magic == ARENA_MAGIC);
+
+  /* Check that the block is properly aligned for the arena. */
+  ASSERT(a->desc == NULL || ((uintptr_t)b % PAGE_SIZE - sizeof *a) % a->desc->block_size == 0);
+  ASSERT(a->desc != NULL || (uintptr_t)b % PAGE_SIZE == sizeof *a);
+
+  return a;
+}
+
+/* Returns the (IDX - 1)'th block within arena A. */
+static struct block* arena_to_block(struct arena* a, size_t idx) {
+  ASSERT(a != NULL);
+  ASSERT(a->magic == ARENA_MAGIC);
+  ASSERT(idx < a->desc->blocks_per_arena);
+  return (struct block*)((uint8_t*)a + sizeof *a + idx * a->desc->block_size);
+}
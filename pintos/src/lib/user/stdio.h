@@ -1,7 +1,18 @@
 #ifndef __LIB_USER_STDIO_H
 #define __LIB_USER_STDIO_H
 
+/* Default size of the standard output buffer. */
+#define BUFSIZ 4096
+
+/* Buffering modes for hsetvbuf(). */
+#define _IOFBF 0 /* Full buffering: write when the buffer fills. */
+#define _IOLBF 1 /* Line buffering: also write at each new-line. */
+#define _IONBF 2 /* No buffering: write immediately. */
+
 int hprintf(int, const char*, ...) PRINTF_FORMAT(2, 3);
 int vhprintf(int, const char*, va_list) PRINTF_FORMAT(2, 0);
+int hwrite(int, const void*, size_t);
+int hflush(int);
+int hsetvbuf(int, char* buf, int mode, size_t size);
 
 #endif /* lib/user/stdio.h */
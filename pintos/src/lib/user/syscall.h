@@ -2,6 +2,7 @@
 #define __LIB_USER_SYSCALL_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <debug.h>
 
 /* Process identifier. */
@@ -46,4 +47,16 @@ bool readdir(int fd, char name[READDIR_MAX_LEN + 1]);
 bool isdir(int fd);
 int inumber(int fd);
 
+/* Extensions. */
+int64_t clock_ns(void);
+void* sbrk(intptr_t increment);
+
+/* Read from the kernel data pages, without a system call. */
+int64_t get_ticks(void);
+int get_timer_freq(void);
+int get_load_avg(void);
+uint32_t get_boot_time(void);
+pid_t getpid(void);
+pid_t getppid(void);
+
 #endif /* lib/user/syscall.h */
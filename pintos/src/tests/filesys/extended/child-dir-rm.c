@@ -0,0 +1,47 @@
+/* Child process for dir-rm-hashed.
+   Fills a directory of its own, then removes the files in the
+   order it created them, over several rounds.  Removing them in
+   that order leaves long runs of tombstones for the directory
+   code to sweep up, while our siblings do the same in their own
+   directories. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <syscall.h>
+#include "tests/lib.h"
+
+const char* test_name = "child-dir-rm";
+
+/* Files per round, one less than a new directory's capacity. */
+#define FILE_CNT 15
+
+/* Number of times to fill and empty the directory. */
+#define ROUND_CNT 4
+
+int main(int argc, const char* argv[]) {
+  char dir[16];
+  char name[32];
+  int child_idx;
+  int round, i;
+
+  quiet = true;
+
+  CHECK(argc == 2, "argc must be 2, actually %d", argc);
+  child_idx = atoi(argv[1]);
+
+  snprintf(dir, sizeof dir, "d%d", child_idx);
+  CHECK(mkdir(dir), "mkdir \"%s\"", dir);
+  for (round = 0; round < ROUND_CNT; round++) {
+    for (i = 0; i < FILE_CNT; i++) {
+      snprintf(name, sizeof name, "%s/f%d", dir, i);
+      CHECK(create(name, 512), "create \"%s\"", name);
+    }
+    for (i = 0; i < FILE_CNT; i++) {
+      snprintf(name, sizeof name, "%s/f%d", dir, i);
+      CHECK(remove(name), "remove \"%s\"", name);
+    }
+  }
+  CHECK(remove(dir), "remove \"%s\"", dir);
+
+  return child_idx;
+}
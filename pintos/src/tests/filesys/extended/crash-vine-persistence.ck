@@ -0,0 +1,51 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+my (@output) = read_text_file ("$test.output");
+common_checks ("file system extraction run", @output);
+
+# The machine lost power partway through growing the vine, so
+# any number of levels may have survived, but they must form an
+# unbroken chain start/file0, start/dir0, start/dir0/file1, ...
+# with nothing else in it.  The file created last may have lost
+# its contents, which are not journaled, but not its length.
+my (%fs) = read_tar ("$prereq_tests[0].tar");
+delete $fs{'tar'};
+delete $fs{'crash-vine'};
+my ($dir) = 'start';
+fail "$dir is missing from the file system\n" if !exists $fs{$dir};
+fail "$dir should be a directory\n" if !is_dir ($fs{$dir});
+delete $fs{$dir};
+
+my ($levels);
+for ($levels = 0; ; $levels++) {
+    my ($file_name) = "$dir/file$levels";
+    last if !exists $fs{$file_name};
+    fail "$file_name should be an ordinary file\n" if is_dir ($fs{$file_name});
+
+    my ($expected) = "contents $levels\n";
+    my ($file, $length) = open_file ($fs{$file_name});
+    fail "$file_name is $length bytes long, expected " . length ($expected) . "\n"
+      if $length != length ($expected);
+    my ($actual) = '';
+    sysread ($file, $actual, $length);
+    close ($file);
+    fail "$file_name has wrong contents\n"
+      if $actual ne $expected && $actual ne "\0" x $length;
+    delete $fs{$file_name};
+
+    my ($dir_name) = "$dir/dir$levels";
+    last if !exists $fs{$dir_name};
+    fail "$dir_name should be a directory\n" if !is_dir ($fs{$dir_name});
+    delete $fs{$dir_name};
+    $dir = $dir_name;
+}
+
+if (%fs) {
+    print "Unexpected files in file system after $levels levels:\n";
+    print "  $_\n" foreach sort keys %fs;
+    fail;
+}
+fail "No levels of the vine survived the crash\n" if $levels == 0;
+pass;
@@ -0,0 +1,43 @@
+/* Grows a "vine" of directories, /start/dir0/dir1/..., with an
+   ordinary file in each of them, while the kernel is set up to
+   lose power partway through (see the -crash option in
+   Make.tests).  The persistence check then verifies that the
+   file system that survives, after journal recovery, holds an
+   unbroken prefix of the vine. */
+
+#include <string.h>
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Number of levels to create if the machine stays up. */
+#define LEVELS 30
+
+void test_main(void) {
+  int i;
+
+  msg("creating levels of files and directories...");
+  quiet = true;
+  CHECK(mkdir("start"), "mkdir \"start\"");
+  CHECK(chdir("start"), "chdir \"start\"");
+  for (i = 0; i < LEVELS; i++) {
+    char file_name[16], dir_name[16];
+    char contents[128];
+    int fd;
+
+    snprintf(file_name, sizeof file_name, "file%d", i);
+    snprintf(contents, sizeof contents, "contents %d\n", i);
+    CHECK(create(file_name, strlen(contents)), "create \"%s\"", file_name);
+    CHECK((fd = open(file_name)) > 1, "open \"%s\"", file_name);
+    CHECK(write(fd, contents, strlen(contents)) == (int)strlen(contents),
+          "write \"%s\"", file_name);
+    close(fd);
+
+    snprintf(dir_name, sizeof dir_name, "dir%d", i);
+    CHECK(mkdir(dir_name), "mkdir \"%s\"", dir_name);
+    CHECK(chdir(dir_name), "chdir \"%s\"", dir_name);
+  }
+  quiet = false;
+  fail("machine should have lost power before creating %d levels", LEVELS);
+}
@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+my (@output) = read_text_file ("$test.output");
+fail "Run produced no output at all\n" if @output == 0;
+check_for_panic ("run", @output);
+check_for_keyword ("run", "FAIL", @output);
+check_for_triple_fault ("run", @output);
+fail "Run didn't start up properly: no \"Boot complete\" message\n"
+  if !grep (/Boot complete/, @output);
+fail "Run didn't start creating the vine\n"
+  if !grep (/^\(crash-vine\) creating levels/, @output);
+fail "Run didn't lose power: no \"Simulating power failure\" message\n"
+  if !grep (/Simulating power failure/, @output);
+pass;
@@ -0,0 +1,6 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_archive ({"child-dir-rm" => "tests/filesys/extended/child-dir-rm"});
+pass;
@@ -0,0 +1,17 @@
+/* Runs several processes at once, each of which fills a
+   directory and empties it again, over several rounds.  Each
+   removal may sweep up a run of tombstones in its directory
+   while the other processes write to the file system. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define CHILD_CNT 4
+
+void test_main(void) {
+  pid_t children[CHILD_CNT];
+
+  exec_children("child-dir-rm", children, CHILD_CNT);
+  wait_children(children, CHILD_CNT);
+}
@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(dir-rm-hashed) begin
+(dir-rm-hashed) exec child 1 of 4: "child-dir-rm 0"
+(dir-rm-hashed) exec child 2 of 4: "child-dir-rm 1"
+(dir-rm-hashed) exec child 3 of 4: "child-dir-rm 2"
+(dir-rm-hashed) exec child 4 of 4: "child-dir-rm 3"
+(dir-rm-hashed) wait for child 1 of 4 returned 0 (expected 0)
+(dir-rm-hashed) wait for child 2 of 4 returned 1 (expected 1)
+(dir-rm-hashed) wait for child 3 of 4 returned 2 (expected 2)
+(dir-rm-hashed) wait for child 4 of 4 returned 3 (expected 3)
+(dir-rm-hashed) end
+EOF
+pass;
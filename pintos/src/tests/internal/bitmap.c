@@ -0,0 +1,102 @@
+/* Benchmark for searching and counting in lib/kernel/bitmap.c.
+
+   Fills a bitmap of 1M bits at random to several levels, then
+   times bitmap_scan() for free runs of various lengths and
+   bitmap_count() over the whole map, and checks their results
+   against bit-by-bit tests.
+
+   This is not a test we will run on your submitted projects.
+   It is here for completeness.
+*/
+
+#undef NDEBUG
+#include <bitmap.h>
+#include <debug.h>
+#include <random.h>
+#include <stdio.h>
+#include "devices/timer.h"
+#include "threads/test.h"
+
+/* Number of bits in the bitmap. */
+#define BIT_CNT (1024 * 1024)
+
+/* Times each measurement is repeated. */
+#define REPEAT_CNT 10
+
+/* Percentage of bits set, for each pass. */
+static const int fill_levels[] = {0, 50, 90, 99, 100};
+
+/* Lengths of the runs of free bits to search for. */
+static const size_t run_lengths[] = {1, 8, 64};
+
+#define ARRAY_CNT(A) (sizeof(A) / sizeof *(A))
+
+static void fill(struct bitmap*, int percent);
+static size_t slow_count(const struct bitmap*);
+
+/* Benchmark bitmap_scan() and bitmap_count(). */
+void test(void) {
+  struct bitmap* b = bitmap_create(BIT_CNT);
+  size_t i, j;
+
+  ASSERT(b != NULL);
+  printf("%d-bit map, average time per call in us:\n", BIT_CNT);
+  printf("fill   scan(1)  scan(8) scan(64)    count\n");
+  for (i = 0; i < ARRAY_CNT(fill_levels); i++) {
+    int64_t start;
+    size_t cnt = 0;
+    int k;
+
+    fill(b, fill_levels[i]);
+    printf("%3d%%", fill_levels[i]);
+
+    for (j = 0; j < ARRAY_CNT(run_lengths); j++) {
+      size_t len = run_lengths[j];
+      size_t idx = 0;
+
+      start = timer_now_ns();
+      for (k = 0; k < REPEAT_CNT; k++)
+        idx = bitmap_scan(b, 0, len, false);
+      printf(" %8lld", (timer_now_ns() - start) / REPEAT_CNT / 1000);
+
+      /* The run found must be free, and must not extend
+         backward into a longer one. */
+      if (idx != BITMAP_ERROR) {
+        ASSERT(!bitmap_contains(b, idx, len, true));
+        ASSERT(idx == 0 || bitmap_test(b, idx - 1));
+      }
+      if (len == 1) {
+        ASSERT(bitmap_all(b, 0, idx != BITMAP_ERROR ? idx : BIT_CNT));
+      }
+    }
+
+    start = timer_now_ns();
+    for (k = 0; k < REPEAT_CNT; k++)
+      cnt = bitmap_count(b, 0, BIT_CNT, true);
+    printf(" %8lld\n", (timer_now_ns() - start) / REPEAT_CNT / 1000);
+    ASSERT(cnt == slow_count(b));
+  }
+
+  bitmap_destroy(b);
+  printf("bitmap: PASS\n");
+}
+
+/* Sets PERCENT percent of the bits in B, chosen at random, and
+   clears the rest. */
+static void fill(struct bitmap* b, int percent) {
+  size_t i;
+
+  for (i = 0; i < BIT_CNT; i++)
+    bitmap_set(b, i, (int)(random_ulong() % 100) < percent);
+}
+
+/* Counts the set bits in B one at a time. */
+static size_t slow_count(const struct bitmap* b) {
+  size_t cnt = 0;
+  size_t i;
+
+  for (i = 0; i < BIT_CNT; i++)
+    if (bitmap_test(b, i))
+      cnt++;
+  return cnt;
+}
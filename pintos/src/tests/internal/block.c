@@ -0,0 +1,100 @@
+/* Benchmark for request queueing in devices/ide.c.
+
+   Reads the same set of randomly chosen sectors from the file
+   system device twice: first one request at a time, each waited
+   for before the next is submitted, so that the disk serves them
+   in random order, and then all at once, so that the elevator
+   can serve them in sector order.  Finally reads a run of
+   consecutive sectors as separate single-sector requests
+   submitted together, which the driver should merge into a few
+   commands.  Reports the time taken by each pass.
+
+   Only reads are issued, so the device's contents are not
+   disturbed.
+
+   This is not a test we will run on your submitted projects.
+   It is here for completeness.
+*/
+
+#undef NDEBUG
+#include <debug.h>
+#include <random.h>
+#include <stdio.h>
+#include "devices/block.h"
+#include "devices/timer.h"
+#include "threads/palloc.h"
+#include "threads/test.h"
+#include "threads/vaddr.h"
+
+/* Number of sectors read in each pass. */
+#define REQUEST_CNT 256
+
+/* Pages needed to hold REQUEST_CNT sectors. */
+#define PAGE_CNT (REQUEST_CNT * BLOCK_SECTOR_SIZE / PGSIZE)
+
+static struct block_request requests[REQUEST_CNT];
+static block_sector_t sectors[REQUEST_CNT];
+
+static int64_t read_one_at_a_time(struct block*, uint8_t* buffer);
+static int64_t read_all_at_once(struct block*, uint8_t* buffer);
+static void report(const char* pass, int64_t elapsed);
+
+/* Benchmark random and sorted block device access. */
+void test(void) {
+  struct block* block = block_get_role(BLOCK_FILESYS);
+  block_sector_t first;
+  uint8_t* buffer;
+  int i;
+
+  ASSERT(block != NULL);
+  ASSERT(block_size(block) > REQUEST_CNT);
+  buffer = palloc_get_multiple(PAL_ASSERT, PAGE_CNT);
+
+  for (i = 0; i < REQUEST_CNT; i++)
+    sectors[i] = random_ulong() % block_size(block);
+  report("random, one at a time", read_one_at_a_time(block, buffer));
+  report("random, all at once", read_all_at_once(block, buffer));
+
+  first = random_ulong() % (block_size(block) - REQUEST_CNT);
+  for (i = 0; i < REQUEST_CNT; i++)
+    sectors[i] = first + i;
+  report("sequential, all at once", read_all_at_once(block, buffer));
+
+  palloc_free_multiple(buffer, PAGE_CNT);
+  printf("block: PASS\n");
+}
+
+/* Reads each of `sectors' from BLOCK into BUFFER, waiting for
+   each read before starting the next, and returns the number of
+   timer ticks taken. */
+static int64_t read_one_at_a_time(struct block* block, uint8_t* buffer) {
+  int64_t start = timer_ticks();
+  int i;
+
+  for (i = 0; i < REQUEST_CNT; i++)
+    block_read(block, sectors[i], buffer + i * BLOCK_SECTOR_SIZE);
+  return timer_elapsed(start);
+}
+
+/* Submits reads of all of `sectors' from BLOCK into BUFFER, then
+   waits for all of them, and returns the number of timer ticks
+   taken. */
+static int64_t read_all_at_once(struct block* block, uint8_t* buffer) {
+  int64_t start = timer_ticks();
+  int i;
+
+  for (i = 0; i < REQUEST_CNT; i++) {
+    block_request_init(&requests[i], false, sectors[i], 1, buffer + i * BLOCK_SECTOR_SIZE, NULL,
+                       NULL);
+    block_submit(block, &requests[i]);
+  }
+  for (i = 0; i < REQUEST_CNT; i++)
+    block_wait(&requests[i]);
+  return timer_elapsed(start);
+}
+
+/* Prints the time ELAPSED, in timer ticks, taken by PASS. */
+static void report(const char* pass, int64_t elapsed) {
+  printf("%-24s %4d sectors in %lld ms\n", pass, REQUEST_CNT,
+         (long long)elapsed * 1000 / TIMER_FREQ);
+}
@@ -0,0 +1,42 @@
+/* Benchmark for console output through lib/kernel/console.c,
+   devices/serial.c and devices/vga.c.
+
+   Prints LINE_CNT lines of text, which scroll the VGA display
+   many times over, and reports the rate in lines per second.  Run
+   it once as usual and once with the `pintos' -v option, which
+   leaves out the emulated display, to see how much of the cost
+   is due to the display.
+
+   This is not a test we will run on your submitted projects.
+   It is here for completeness.
+*/
+
+#undef NDEBUG
+#include <stdio.h>
+#include "devices/serial.h"
+#include "devices/timer.h"
+#include "devices/vga.h"
+#include "threads/test.h"
+
+/* Number of lines to print. */
+#define LINE_CNT 10000
+
+/* Benchmark console output. */
+void test(void) {
+  int64_t start, elapsed;
+  int i;
+
+  start = timer_ticks();
+  for (i = 0; i < LINE_CNT; i++)
+    printf("console benchmark line %5d of %d: the quick brown fox jumps over the lazy dog\n", i,
+           LINE_CNT);
+  serial_flush();
+  vga_flush();
+  elapsed = timer_elapsed(start);
+  if (elapsed == 0)
+    elapsed = 1;
+
+  printf("%d lines in %lld ms: %lld lines/s\n", LINE_CNT, (long long)elapsed * 1000 / TIMER_FREQ,
+         (long long)LINE_CNT * TIMER_FREQ / elapsed);
+  printf("console: PASS\n");
+}
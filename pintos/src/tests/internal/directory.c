@@ -0,0 +1,115 @@
+/* Benchmark for the directory formats in filesys/directory.c.
+
+   Fills directories of 10, 1,000 and 10,000 entries and reports
+   how long it takes to add every entry and then to look every
+   entry up again, in random order.  Each size is run against the
+   hashed format that dir_create() now produces and, where it
+   finishes in reasonable time, against the original linear
+   format for comparison.  Lookups of more names than the dentry
+   cache holds mostly miss it, so they measure the directory
+   format itself.
+
+   All entries refer to a single file inode, so only the
+   directories themselves take up space on the file system
+   device.
+
+   This is not a test we will run on your submitted projects.
+   It is here for completeness.
+*/
+
+#undef NDEBUG
+#include <debug.h>
+#include <random.h>
+#include <stdio.h>
+#include "devices/timer.h"
+#include "filesys/directory.h"
+#include "filesys/free-map.h"
+#include "filesys/inode.h"
+#include "threads/test.h"
+
+/* Largest directory benchmarked with the linear format. */
+#define MAX_LINEAR 1000
+
+/* Size of a struct dir_entry, which is private to
+   filesys/directory.c. */
+#define DIR_ENTRY_SIZE 20
+
+static void run(size_t cnt, unsigned flags, block_sector_t target);
+static void shuffle(size_t[], size_t);
+
+/* Benchmark directory creates and lookups. */
+void test(void) {
+  static const size_t sizes[] = {10, 1000, 10000};
+  block_sector_t target;
+  size_t i;
+
+  ASSERT(free_map_allocate(1, &target));
+  ASSERT(inode_create(target, 0, 0));
+
+  for (i = 0; i < sizeof sizes / sizeof *sizes; i++) {
+    run(sizes[i], INODE_DIR | INODE_DIR_HASHED, target);
+    if (sizes[i] <= MAX_LINEAR)
+      run(sizes[i], INODE_DIR, target);
+  }
+
+  free_map_release(target, 1);
+  printf("directory: PASS\n");
+}
+
+/* Creates a directory with CNT slots and the given inode FLAGS,
+   adds CNT names referring to TARGET to it, looks them all up,
+   and prints the time taken by each phase. */
+static void run(size_t cnt, unsigned flags, block_sector_t target) {
+  static size_t order[10000];
+  block_sector_t sector;
+  struct dir* dir;
+  int64_t start, add_ticks, lookup_ticks;
+  size_t i;
+
+  ASSERT(cnt <= sizeof order / sizeof *order);
+  ASSERT(free_map_allocate(1, &sector));
+  ASSERT(inode_create(sector, cnt * DIR_ENTRY_SIZE, flags));
+  dir = dir_open(inode_open(sector));
+  ASSERT(dir != NULL);
+
+  start = timer_ticks();
+  for (i = 0; i < cnt; i++) {
+    char name[NAME_MAX + 1];
+    snprintf(name, sizeof name, "f%zu", i);
+    ASSERT(dir_add(dir, name, target));
+  }
+  add_ticks = timer_elapsed(start);
+
+  for (i = 0; i < cnt; i++)
+    order[i] = i;
+  shuffle(order, cnt);
+
+  start = timer_ticks();
+  for (i = 0; i < cnt; i++) {
+    char name[NAME_MAX + 1];
+    struct inode* inode;
+    snprintf(name, sizeof name, "f%zu", order[i]);
+    ASSERT(dir_lookup(dir, name, &inode));
+    ASSERT(inode_get_inumber(inode) == target);
+    inode_close(inode);
+  }
+  lookup_ticks = timer_elapsed(start);
+
+  printf("%6s %5zu entries: %lld ticks to add, %lld ticks to look up\n",
+         flags & INODE_DIR_HASHED ? "hashed" : "linear", cnt, add_ticks, lookup_ticks);
+
+  inode_remove(dir_get_inode(dir));
+  dir_close(dir);
+}
+
+/* Shuffles the CNT elements in ARRAY into random order. */
+static void shuffle(size_t* array, size_t cnt) {
+  size_t i;
+
+  for (i = 0; i < cnt; i++) {
+    size_t j = i + random_ulong() % (cnt - i);
+    size_t t = array[j];
+    array[j] = array[i];
+    array[i] = t;
+  }
+}
@@ -0,0 +1,185 @@
+/* Benchmark comparing the chained hash table in lib/kernel/hash.c
+   with the open-addressing one in lib/kernel/ohash.c.
+
+   Inserts integer keys in random order into each kind of table,
+   looks each of them up, looks up the same number of keys that
+   are not present, and then deletes them all, checking every
+   result.  Reports the average time per operation for tables of
+   several sizes.
+
+   This is not a test we will run on your submitted projects.
+   It is here for completeness.
+*/
+
+#undef NDEBUG
+#include <debug.h>
+#include <hash.h>
+#include <ohash.h>
+#include <random.h>
+#include <stdio.h>
+#include "devices/timer.h"
+#include "threads/malloc.h"
+#include "threads/test.h"
+
+/* Largest number of elements in a table. */
+#define MAX_CNT (16 * 1024)
+
+/* An element that can be in either kind of table. */
+struct item {
+  struct hash_elem hash_elem;
+  struct ohash_elem ohash_elem;
+  int key;
+};
+
+/* Phases timed for each table. */
+enum phase { INSERT, FIND_HIT, FIND_MISS, DELETE, PHASE_CNT };
+
+static struct item* items;
+
+static void run_hash(size_t cnt, int64_t times[PHASE_CNT]);
+static void run_ohash(size_t cnt, int64_t times[PHASE_CNT]);
+static void report(const char* name, size_t cnt, const int64_t times[PHASE_CNT]);
+static void shuffle(size_t cnt);
+static hash_hash_func item_hash;
+static hash_less_func item_less;
+static ohash_hash_func item_ohash;
+static ohash_equal_func item_equal;
+
+/* Benchmark both hash tables. */
+void test(void) {
+  size_t cnt;
+
+  items = malloc(sizeof *items * MAX_CNT);
+  ASSERT(items != NULL);
+
+  printf("ns per operation:\n");
+  printf("table  elements   insert find-hit find-miss   delete\n");
+  for (cnt = 256; cnt <= MAX_CNT; cnt *= 4) {
+    int64_t times[PHASE_CNT];
+
+    shuffle(cnt);
+    run_hash(cnt, times);
+    report("hash", cnt, times);
+    run_ohash(cnt, times);
+    report("ohash", cnt, times);
+  }
+
+  free(items);
+  printf("hash: PASS\n");
+}
+
+/* Times each phase on a struct hash with CNT elements. */
+static void run_hash(size_t cnt, int64_t times[PHASE_CNT]) {
+  struct hash h;
+  struct item key;
+  int64_t start;
+  size_t i;
+
+  ASSERT(hash_init(&h, item_hash, item_less, NULL));
+
+  start = timer_now_ns();
+  for (i = 0; i < cnt; i++)
+    ASSERT(hash_insert(&h, &items[i].hash_elem) == NULL);
+  times[INSERT] = timer_now_ns() - start;
+
+  start = timer_now_ns();
+  for (i = 0; i < cnt; i++) {
+    key.key = items[i].key;
+    ASSERT(hash_find(&h, &key.hash_elem) == &items[i].hash_elem);
+  }
+  times[FIND_HIT] = timer_now_ns() - start;
+
+  start = timer_now_ns();
+  for (i = 0; i < cnt; i++) {
+    key.key = -items[i].key - 1;
+    ASSERT(hash_find(&h, &key.hash_elem) == NULL);
+  }
+  times[FIND_MISS] = timer_now_ns() - start;
+
+  start = timer_now_ns();
+  for (i = 0; i < cnt; i++)
+    ASSERT(hash_delete(&h, &items[i].hash_elem) == &items[i].hash_elem);
+  times[DELETE] = timer_now_ns() - start;
+
+  ASSERT(hash_empty(&h));
+  hash_destroy(&h, NULL);
+}
+
+/* Times each phase on a struct ohash with CNT elements. */
+static void run_ohash(size_t cnt, int64_t times[PHASE_CNT]) {
+  struct ohash h;
+  struct item key;
+  int64_t start;
+  size_t i;
+
+  ASSERT(ohash_init(&h, item_ohash, item_equal, NULL));
+
+  start = timer_now_ns();
+  for (i = 0; i < cnt; i++)
+    ASSERT(ohash_insert(&h, &items[i].ohash_elem) == NULL);
+  times[INSERT] = timer_now_ns() - start;
+
+  start = timer_now_ns();
+  for (i = 0; i < cnt; i++) {
+    key.key = items[i].key;
+    ASSERT(ohash_find(&h, &key.ohash_elem) == &items[i].ohash_elem);
+  }
+  times[FIND_HIT] = timer_now_ns() - start;
+
+  start = timer_now_ns();
+  for (i = 0; i < cnt; i++) {
+    key.key = -items[i].key - 1;
+    ASSERT(ohash_find(&h, &key.ohash_elem) == NULL);
+  }
+  times[FIND_MISS] = timer_now_ns() - start;
+
+  start = timer_now_ns();
+  for (i = 0; i < cnt; i++)
+    ASSERT(ohash_delete(&h, &items[i].ohash_elem) == &items[i].ohash_elem);
+  times[DELETE] = timer_now_ns() - start;
+
+  ASSERT(ohash_empty(&h));
+  ohash_destroy(&h, NULL);
+}
+
+/* Prints the TIMES taken by table NAME with CNT elements. */
+static void report(const char* name, size_t cnt, const int64_t times[PHASE_CNT]) {
+  int phase;
+
+  printf("%-5s %9zu", name, cnt);
+  for (phase = 0; phase < PHASE_CNT; phase++)
+    printf(" %8lld", times[phase] / (int64_t)cnt);
+  printf("\n");
+}
+
+/* Gives the first CNT items keys 0...CNT - 1 in random order. */
+static void shuffle(size_t cnt) {
+  size_t i;
+
+  for (i = 0; i < cnt; i++)
+    items[i].key = i;
+  for (i = 0; i < cnt; i++) {
+    size_t j = i + random_ulong() % (cnt - i);
+    int t = items[i].key;
+    items[i].key = items[j].key;
+    items[j].key = t;
+  }
+}
+
+/* Hash and comparison functions for both kinds of table. */
+static unsigned item_hash(const struct hash_elem* e, void* aux UNUSED) {
+  return hash_int(hash_entry(e, struct item, hash_elem)->key);
+}
+
+static bool item_less(const struct hash_elem* a, const struct hash_elem* b, void* aux UNUSED) {
+  return hash_entry(a, struct item, hash_elem)->key < hash_entry(b, struct item, hash_elem)->key;
+}
+
+static unsigned item_ohash(const struct ohash_elem* e, void* aux UNUSED) {
+  return hash_int(ohash_entry(e, struct item, ohash_elem)->key);
+}
+
+static bool item_equal(const struct ohash_elem* a, const struct ohash_elem* b, void* aux UNUSED) {
+  return ohash_entry(a, struct item, ohash_elem)->key ==
+         ohash_entry(b, struct item, ohash_elem)->key;
+}
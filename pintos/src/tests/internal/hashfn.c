@@ -0,0 +1,172 @@
+/* Test and benchmark for the hash functions in lib/kernel/hash.c.
+
+   First checks hash_bytes() and hash_string() against published
+   MurmurHash3_x86_32 values for the seed they use.  Then checks
+   that hash_int(), hash_ptr(), and hash_string()
+   spread typical keys (runs of integers, page addresses, sector
+   numbers, and short file names) evenly over the buckets of a
+   table indexed by the low bits of the hash, as struct hash and
+   struct ohash are, by computing a chi-squared statistic for each
+   key set.  Then reports the throughput of hash_bytes() for
+   several buffer sizes and of hash_int(), alongside the
+   byte-at-a-time FNV-1 hash they replaced.
+
+   This is not a test we will run on your submitted projects.
+   It is here for completeness.
+*/
+
+#undef NDEBUG
+#include <debug.h>
+#include <hash.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "devices/timer.h"
+#include "threads/test.h"
+
+/* Buckets in the table used to check distribution. */
+#define BUCKET_BITS 10
+#define BUCKET_CNT (1 << BUCKET_BITS)
+
+/* Keys hashed into the table, 8 per bucket on average. */
+#define KEY_CNT (8 * BUCKET_CNT)
+
+/* Kinds of key checked for distribution. */
+enum key_kind { INTS, PAGES, SECTORS, NAMES, KIND_CNT };
+static const char* kind_names[KIND_CNT] = {"integers", "pages", "sectors", "names"};
+
+/* Bytes hashed for each buffer size in the throughput test, and
+   integers hashed in that test. */
+#define BYTES_PER_SIZE (4 * 1024 * 1024)
+#define INT_CNT (4 * 1024 * 1024)
+
+/* MurmurHash3_x86_32 of each string with seed 0x9747b28c, the
+   seed used by hash_bytes() and hash_string().  The last two are
+   published test vectors; the rest exercise each tail length. */
+static const struct {
+  const char* s;
+  unsigned hash;
+} vectors[] = {
+    {"", 0xebb6c228},
+    {"a", 0x7fa09ea6},
+    {"ab", 0x74875592},
+    {"abc", 0xc84a62dd},
+    {"abcd", 0xf0478627},
+    {"Hello, world!", 0x24884cba},
+    {"The quick brown fox jumps over the lazy dog", 0x2fa826cd},
+};
+
+/* Receives hash values in the throughput test, so that the
+   compiler cannot drop the calls. */
+static volatile unsigned sink;
+
+static unsigned key_hash(enum key_kind, int i);
+static unsigned chi_squared(enum key_kind);
+static unsigned fnv_bytes(const void*, size_t);
+static void time_bytes(const char* name, unsigned (*)(const void*, size_t));
+
+/* Test hash function distribution and throughput. */
+void test(void) {
+  enum key_kind kind;
+  int64_t start, elapsed;
+  size_t v;
+  int i;
+
+  for (v = 0; v < sizeof vectors / sizeof *vectors; v++) {
+    ASSERT(hash_bytes(vectors[v].s, strlen(vectors[v].s)) == vectors[v].hash);
+    ASSERT(hash_string(vectors[v].s) == vectors[v].hash);
+  }
+  printf("murmur3 reference vectors: ok\n");
+
+  /* The statistic divided by BUCKET_CNT should be close to 1 for
+     a random-looking hash.  Runs of keys often come out more
+     evenly than that, so only the upper limit is checked. */
+  printf("chi-squared / buckets, %d keys in %d buckets:\n", KEY_CNT, BUCKET_CNT);
+  for (kind = 0; kind < KIND_CNT; kind++) {
+    unsigned x = chi_squared(kind);
+    printf("  %-10s %u.%02u\n", kind_names[kind], x / 100, x % 100);
+    ASSERT(x < 150);
+  }
+
+  printf("hash_bytes() throughput, MB/s:\n");
+  time_bytes("murmur3", hash_bytes);
+  time_bytes("fnv-1", fnv_bytes);
+
+  start = timer_now_ns();
+  for (i = 0; i < INT_CNT; i++)
+    sink = hash_int(i);
+  elapsed = timer_now_ns() - start;
+  printf("hash_int() throughput: %lld calls/us\n", elapsed > 0 ? INT_CNT * 1000LL / elapsed : 0);
+
+  printf("hashfn: PASS\n");
+}
+
+/* Returns the hash of the Ith key of the given KIND. */
+static unsigned key_hash(enum key_kind kind, int i) {
+  char name[16];
+
+  switch (kind) {
+    case INTS:
+      return hash_int(i);
+    case PAGES:
+      return hash_ptr((void*)(0xc0000000 + (uintptr_t)i * 4096));
+    case SECTORS:
+      return hash_int(1000 + i * 8);
+    case NAMES:
+      snprintf(name, sizeof name, "file%d", i);
+      return hash_string(name);
+    default:
+      NOT_REACHED();
+  }
+}
+
+/* Hashes KEY_CNT keys of the given KIND into BUCKET_CNT buckets
+   by their low bits and returns the chi-squared statistic,
+   divided by BUCKET_CNT and multiplied by 100. */
+static unsigned chi_squared(enum key_kind kind) {
+  static unsigned counts[BUCKET_CNT];
+  unsigned expected = KEY_CNT / BUCKET_CNT;
+  uint64_t sum = 0;
+  int i;
+
+  memset(counts, 0, sizeof counts);
+  for (i = 0; i < KEY_CNT; i++)
+    counts[key_hash(kind, i) & (BUCKET_CNT - 1)]++;
+  for (i = 0; i < BUCKET_CNT; i++) {
+    int d = (int)counts[i] - (int)expected;
+    sum += d * d;
+  }
+  return sum * 100 / expected / BUCKET_CNT;
+}
+
+/* The FNV-1 32-bit hash formerly used by hash_bytes(), for
+   comparison. */
+static unsigned fnv_bytes(const void* buf_, size_t size) {
+  const unsigned char* buf = buf_;
+  unsigned hash = 2166136261u;
+
+  while (size-- > 0)
+    hash = (hash * 16777619u) ^ *buf++;
+  return hash;
+}
+
+/* Prints the throughput of HASH, called NAME, on buffers of
+   several sizes. */
+static void time_bytes(const char* name, unsigned (*hash)(const void*, size_t)) {
+  static char buf[4096];
+  size_t size;
+
+  memset(buf, 'x', sizeof buf);
+  printf("  %-8s", name);
+  for (size = 16; size <= sizeof buf; size *= 4) {
+    int64_t start = timer_now_ns();
+    int64_t elapsed;
+    size_t i;
+
+    for (i = 0; i < BYTES_PER_SIZE / size; i++)
+      sink = hash(buf, size);
+    elapsed = timer_now_ns() - start;
+    printf(" %5zu B: %5lld", size, elapsed > 0 ? BYTES_PER_SIZE * 1000LL / elapsed : 0);
+  }
+  printf("\n");
+}
@@ -0,0 +1,181 @@
+/* Test program for lib/kernel/heap.c.
+
+   Applies random insertions, removals and key changes to heaps
+   of up to MAX_SIZE elements and checks the heap order, the
+   links, and that the least element comes out first.  Then
+   models a semaphore with WAITER_CNT waiting threads of random
+   priority and compares the time to wake them all, highest
+   priority first, from a heap and from a list searched with
+   list_max(), as a scheduler without a heap would.
+
+   This is not a test we will run on your submitted projects.
+   It is here for completeness.
+*/
+
+#undef NDEBUG
+#include <debug.h>
+#include <heap.h>
+#include <list.h>
+#include <random.h>
+#include <stdio.h>
+#include "devices/timer.h"
+#include "threads/malloc.h"
+#include "threads/test.h"
+#include "threads/thread.h"
+
+/* Maximum number of elements in a heap that we will check. */
+#define MAX_SIZE 64
+
+/* Number of waiters in the benchmark. */
+#define WAITER_CNT 1000
+
+/* A heap or list element standing in for a waiting thread. */
+struct waiter {
+  struct heap_elem heap_elem; /* Heap element. */
+  struct list_elem list_elem; /* List element. */
+  int priority;               /* Priority, higher is more urgent. */
+  unsigned seq;               /* Arrival order. */
+};
+
+static void test_random(void);
+static void benchmark(void);
+static size_t verify_subtree(struct heap*, struct heap_elem*, struct heap_elem* parent);
+static void verify(struct heap*, bool present[], size_t cnt);
+static heap_less_func waiter_less;
+static list_less_func waiter_list_less;
+
+/* Test the binary heap implementation. */
+void test(void) {
+  test_random();
+  benchmark();
+  printf("heap: PASS\n");
+}
+
+/* Applies random operations to heaps of up to MAX_SIZE elements
+   with many equal priorities, verifying the heap after each
+   one. */
+static void test_random(void) {
+  int size;
+
+  for (size = 1; size <= MAX_SIZE; size++) {
+    struct waiter waiters[MAX_SIZE];
+    bool present[MAX_SIZE];
+    struct heap heap;
+    int i;
+
+    heap_init(&heap, waiter_less, NULL);
+    for (i = 0; i < size; i++) {
+      waiters[i].priority = random_ulong() % (PRI_MAX + 1) / 8;
+      waiters[i].seq = i;
+      present[i] = false;
+    }
+
+    for (i = 0; i < size * 8; i++) {
+      struct waiter* w = &waiters[random_ulong() % size];
+
+      if (!present[w - waiters]) {
+        heap_push(&heap, &w->heap_elem);
+        present[w - waiters] = true;
+      } else if (random_ulong() % 2) {
+        heap_remove(&heap, &w->heap_elem);
+        present[w - waiters] = false;
+      } else {
+        w->priority = random_ulong() % (PRI_MAX + 1) / 8;
+        heap_update(&heap, &w->heap_elem);
+      }
+      verify(&heap, present, size);
+    }
+
+    /* Empty the heap, checking that each element popped is no
+       less urgent than the next. */
+    while (!heap_empty(&heap)) {
+      struct waiter* w = heap_entry(heap_pop(&heap), struct waiter, heap_elem);
+
+      present[w - waiters] = false;
+      ASSERT(heap_empty(&heap) || !waiter_less(heap_top(&heap), &w->heap_elem, NULL));
+      verify(&heap, present, size);
+    }
+  }
+}
+
+/* Checks the links and heap order of the subtree of HEAP rooted
+   at E, whose parent should be PARENT, and returns the number of
+   elements in it. */
+static size_t verify_subtree(struct heap* heap, struct heap_elem* e, struct heap_elem* parent) {
+  if (e == NULL)
+    return 0;
+
+  ASSERT(e->parent == parent);
+  ASSERT(parent == NULL || !waiter_less(e, parent, NULL));
+  ASSERT(e->left != NULL || e->right == NULL);
+  return 1 + verify_subtree(heap, e->left, e) + verify_subtree(heap, e->right, e);
+}
+
+/* Verifies that HEAP is well formed and holds as many elements
+   as are marked in PRESENT[], among CNT. */
+static void verify(struct heap* heap, bool present[], size_t cnt) {
+  size_t expected = 0;
+  size_t i;
+
+  for (i = 0; i < cnt; i++)
+    expected += present[i];
+  ASSERT(heap_size(heap) == expected);
+  ASSERT(heap_empty(heap) == (expected == 0));
+  ASSERT(verify_subtree(heap, heap->root, NULL) == expected);
+}
+
+/* Times waking WAITER_CNT waiters in priority order from a heap
+   and from a list. */
+static void benchmark(void) {
+  struct waiter* waiters = malloc(sizeof *waiters * WAITER_CNT);
+  struct heap heap;
+  struct list list;
+  int64_t start, heap_time, list_time;
+  int i;
+
+  ASSERT(waiters != NULL);
+  for (i = 0; i < WAITER_CNT; i++) {
+    waiters[i].priority = random_ulong() % (PRI_MAX + 1);
+    waiters[i].seq = i;
+  }
+
+  heap_init(&heap, waiter_less, NULL);
+  start = timer_now_ns();
+  for (i = 0; i < WAITER_CNT; i++)
+    heap_push(&heap, &waiters[i].heap_elem);
+  for (i = 0; i < WAITER_CNT; i++)
+    heap_pop(&heap);
+  heap_time = timer_now_ns() - start;
+
+  list_init(&list);
+  start = timer_now_ns();
+  for (i = 0; i < WAITER_CNT; i++)
+    list_push_back(&list, &waiters[i].list_elem);
+  for (i = 0; i < WAITER_CNT; i++)
+    list_remove(list_max(&list, waiter_list_less, NULL));
+  list_time = timer_now_ns() - start;
+
+  printf("%d waiters, ns per wakeup: heap %lld, list %lld\n", WAITER_CNT,
+         heap_time / WAITER_CNT, list_time / WAITER_CNT);
+  free(waiters);
+}
+
+/* Returns true if waiter A should be woken before waiter B. */
+static bool waiter_less(const struct heap_elem* a_, const struct heap_elem* b_, void* aux UNUSED) {
+  const struct waiter* a = heap_entry(a_, struct waiter, heap_elem);
+  const struct waiter* b = heap_entry(b_, struct waiter, heap_elem);
+
+  if (a->priority != b->priority)
+    return a->priority > b->priority;
+  return a->seq < b->seq;
+}
+
+/* Returns true if waiter A should be woken after waiter B, so
+   that list_max() finds the waiter to wake first. */
+static bool waiter_list_less(const struct list_elem* a_, const struct list_elem* b_,
+                             void* aux UNUSED) {
+  const struct waiter* a = list_entry(a_, struct waiter, list_elem);
+  const struct waiter* b = list_entry(b_, struct waiter, list_elem);
+
+  return waiter_less(&b->heap_elem, &a->heap_elem, NULL);
+}
@@ -0,0 +1,67 @@
+/* Benchmark for per-sector latency in devices/ide.c.
+
+   Times single-sector reads of one sector of the file system
+   device, repeated so that the disk's own cache (if any) serves
+   them, and then 64 kB multi-sector reads of the same area.
+   Reports the average time per sector in each case, which is
+   dominated by the driver's own waiting rather than by the
+   transfer itself.
+
+   Only reads are issued, so the device's contents are not
+   disturbed.
+
+   This is not a test we will run on your submitted projects.
+   It is here for completeness.
+*/
+
+#undef NDEBUG
+#include <debug.h>
+#include <stdio.h>
+#include "devices/block.h"
+#include "devices/timer.h"
+#include "threads/palloc.h"
+#include "threads/test.h"
+#include "threads/vaddr.h"
+
+/* Number of sectors read in each pass. */
+#define SECTOR_CNT 4096
+
+/* Sectors per multi-sector read. */
+#define RUN_SECTORS 128
+
+/* Pages needed to hold RUN_SECTORS sectors. */
+#define PAGE_CNT (RUN_SECTORS * BLOCK_SECTOR_SIZE / PGSIZE)
+
+static void report(const char* pass, int64_t elapsed);
+
+/* Benchmark per-sector read latency. */
+void test(void) {
+  struct block* block = block_get_role(BLOCK_FILESYS);
+  uint8_t* buffer;
+  int64_t start;
+  int i;
+
+  ASSERT(block != NULL);
+  ASSERT(block_size(block) >= RUN_SECTORS);
+  buffer = palloc_get_multiple(PAL_ASSERT, PAGE_CNT);
+
+  start = timer_ticks();
+  for (i = 0; i < SECTOR_CNT; i++)
+    block_read(block, 0, buffer);
+  report("1-sector reads", timer_elapsed(start));
+
+  start = timer_ticks();
+  for (i = 0; i < SECTOR_CNT / RUN_SECTORS; i++)
+    block_read_multiple(block, 0, RUN_SECTORS, buffer);
+  report("64 kB reads", timer_elapsed(start));
+
+  palloc_free_multiple(buffer, PAGE_CNT);
+  printf("ide: PASS\n");
+}
+
+/* Prints the time per sector for PASS, which took ELAPSED timer
+   ticks to read SECTOR_CNT sectors. */
+static void report(const char* pass, int64_t elapsed) {
+  printf("%-16s %lld us/sector\n", pass,
+         (long long)elapsed * 1000000 / TIMER_FREQ / SECTOR_CNT);
+}
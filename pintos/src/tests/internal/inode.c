@@ -0,0 +1,75 @@
+/* Benchmark for the open-inode table in filesys/inode.c.
+
+   Creates about a thousand inodes scattered across the file system
+   device, keeps a growing number of them open, and measures how
+   many inode_open()/inode_close() pairs per second can be made
+   against the table at each size.  Every open is of an inode
+   that is already open, so no disk I/O is involved and the
+   figure reflects the cost of the table lookup itself.
+
+   This is not a test we will run on your submitted projects.
+   It is here for completeness.
+*/
+
+#undef NDEBUG
+#include <debug.h>
+#include <random.h>
+#include <stdio.h>
+#include "devices/timer.h"
+#include "filesys/free-map.h"
+#include "filesys/inode.h"
+#include "threads/test.h"
+
+/* Maximum number of inodes held open at once. */
+#define MAX_OPEN 1024
+
+/* Number of open/close pairs timed at each table size. */
+#define ITERATIONS 100000
+
+/* Benchmark the open-inode table. */
+void test(void) {
+  static block_sector_t sectors[MAX_OPEN];
+  static struct inode* inodes[MAX_OPEN];
+  int open_cnt = 0;
+  int cnt;
+
+  printf("creating %d inodes...", MAX_OPEN);
+  for (cnt = 0; cnt < MAX_OPEN; cnt++) {
+    ASSERT(free_map_allocate(1, &sectors[cnt]));
+    ASSERT(inode_create(sectors[cnt], 0, 0));
+  }
+  printf(" done\n");
+
+  for (cnt = 16; cnt <= MAX_OPEN; cnt *= 4) {
+    int64_t start;
+    int64_t elapsed;
+    int i;
+
+    /* Bring the number of open inodes up to CNT. */
+    for (; open_cnt < cnt; open_cnt++) {
+      inodes[open_cnt] = inode_open(sectors[open_cnt]);
+      ASSERT(inodes[open_cnt] != NULL);
+    }
+
+    /* Reopen and close random members of the table. */
+    start = timer_ticks();
+    for (i = 0; i < ITERATIONS; i++) {
+      int idx = random_ulong() % cnt;
+      struct inode* inode = inode_open(sectors[idx]);
+      ASSERT(inode == inodes[idx]);
+      inode_close(inode);
+    }
+    elapsed = timer_elapsed(start);
+    if (elapsed == 0)
+      elapsed = 1;
+
+    printf("%5d open inodes: %lld opens/s\n", cnt,
+           (long long)ITERATIONS * TIMER_FREQ / elapsed);
+  }
+
+  for (cnt = 0; cnt < MAX_OPEN; cnt++) {
+    inode_remove(inodes[cnt]);
+    inode_close(inodes[cnt]);
+  }
+  printf("inode: PASS\n");
+}
@@ -0,0 +1,267 @@
+/* Test program for lib/kernel/rbtree.c.
+
+   Attempts to test the tree functionality that is not
+   sufficiently tested elsewhere in Pintos.  Inserts and removes
+   elements in random order, with duplicate keys, checking the
+   red-black properties, ordered iteration in both directions,
+   and searches after each step.  Then compares the time taken to
+   use a tree and a list_insert_ordered() list as a priority
+   queue of several sizes.
+
+   This is not a test we will run on your submitted projects.
+   It is here for completeness.
+*/
+
+#undef NDEBUG
+#include <debug.h>
+#include <list.h>
+#include <random.h>
+#include <rbtree.h>
+#include <stdio.h>
+#include "devices/timer.h"
+#include "threads/malloc.h"
+#include "threads/test.h"
+
+/* Maximum number of elements in a tree that we will check. */
+#define MAX_SIZE 64
+
+/* Largest number of elements in a benchmarked queue. */
+#define MAX_CNT 4096
+
+/* A tree or list element. */
+struct value {
+  struct rb_elem rb_elem;     /* Tree element. */
+  struct list_elem list_elem; /* List element. */
+  int value;                  /* Item value. */
+};
+
+static void test_random(void);
+static void benchmark(size_t cnt);
+static int verify_subtree(struct rb_elem*, struct rb_elem* parent);
+static void verify(struct rb_tree*, struct value values[], bool present[], size_t cnt);
+static rb_less_func value_less;
+static list_less_func value_list_less;
+
+/* Test the red-black tree implementation. */
+void test(void) {
+  size_t cnt;
+
+  test_random();
+
+  printf("ns per element:\n");
+  printf("queue  elements   insert   remove\n");
+  for (cnt = 64; cnt <= MAX_CNT; cnt *= 4)
+    benchmark(cnt);
+
+  printf("rbtree: PASS\n");
+}
+
+/* Applies random insertions and removals to trees of up to
+   MAX_SIZE elements, whose values are drawn from a range small
+   enough to produce many duplicates, and verifies the tree after
+   each one. */
+static void test_random(void) {
+  int size;
+
+  for (size = 0; size <= MAX_SIZE; size++) {
+    struct value values[MAX_SIZE];
+    bool present[MAX_SIZE];
+    struct rb_tree tree;
+    int i;
+
+    rb_init(&tree, value_less, NULL);
+    for (i = 0; i < size; i++) {
+      values[i].value = random_ulong() % (size / 2 + 1);
+      present[i] = false;
+    }
+
+    for (i = 0; i < size * 8; i++) {
+      int idx = random_ulong() % size;
+
+      if (present[idx])
+        rb_remove(&tree, &values[idx].rb_elem);
+      else
+        rb_insert(&tree, &values[idx].rb_elem);
+      present[idx] = !present[idx];
+      verify(&tree, values, present, size);
+    }
+
+    /* Empty the tree from the front, as a queue would. */
+    while (!rb_empty(&tree)) {
+      struct value* v = rb_entry(rb_first(&tree), struct value, rb_elem);
+      rb_remove(&tree, &v->rb_elem);
+      present[v - values] = false;
+      verify(&tree, values, present, size);
+    }
+  }
+}
+
+/* Checks the subtree rooted at E, whose parent should be PARENT,
+   for ordering and the red-black properties, and returns the
+   number of black nodes on each path from E to a leaf. */
+static int verify_subtree(struct rb_elem* e, struct rb_elem* parent) {
+  int left_height, right_height;
+
+  if (e == NULL)
+    return 1;
+
+  ASSERT(e->parent == parent);
+  ASSERT(!e->red || (parent != NULL && !parent->red));
+  ASSERT(e->left == NULL || !value_less(e, e->left, NULL));
+  ASSERT(e->right == NULL || !value_less(e->right, e, NULL));
+
+  left_height = verify_subtree(e->left, e);
+  right_height = verify_subtree(e->right, e);
+  ASSERT(left_height == right_height);
+  return left_height + !e->red;
+}
+
+/* Verifies that TREE contains exactly the elements of VALUES[]
+   marked in PRESENT[], among CNT, in order in both directions,
+   and that searches for every possible value give the right
+   answer. */
+static void verify(struct rb_tree* tree, struct value values[], bool present[], size_t cnt) {
+  struct rb_elem* e;
+  size_t expected = 0;
+  size_t seen;
+  int key;
+  size_t i;
+
+  for (i = 0; i < cnt; i++)
+    expected += present[i];
+  ASSERT(rb_size(tree) == expected);
+  ASSERT(rb_empty(tree) == (expected == 0));
+  verify_subtree(tree->root, NULL);
+
+  /* Forward iteration visits each present element once, in
+     order. */
+  seen = 0;
+  for (e = rb_first(tree); e != NULL; e = rb_next(e)) {
+    struct value* v = rb_entry(e, struct value, rb_elem);
+    struct rb_elem* next = rb_next(e);
+
+    ASSERT(present[v - values]);
+    ASSERT(next == NULL || !value_less(next, e, NULL));
+    seen++;
+  }
+  ASSERT(seen == expected);
+
+  /* Backward iteration does the same in reverse. */
+  seen = 0;
+  for (e = rb_last(tree); e != NULL; e = rb_prev(e)) {
+    struct rb_elem* prev = rb_prev(e);
+
+    ASSERT(prev == NULL || !value_less(e, prev, NULL));
+    seen++;
+  }
+  ASSERT(seen == expected);
+
+  /* Each search matches a linear scan. */
+  for (key = -1; key <= (int)cnt / 2 + 1; key++) {
+    struct value k;
+    struct rb_elem *lower, *upper, *found;
+    size_t below = 0, equal = 0;
+
+    k.value = key;
+    for (i = 0; i < cnt; i++)
+      if (present[i]) {
+        below += values[i].value < key;
+        equal += values[i].value == key;
+      }
+
+    lower = rb_lower_bound(tree, &k.rb_elem);
+    upper = rb_upper_bound(tree, &k.rb_elem);
+    found = rb_find(tree, &k.rb_elem);
+
+    if (below == expected) {
+      ASSERT(lower == NULL);
+    } else {
+      ASSERT(lower != NULL);
+      ASSERT(!value_less(lower, &k.rb_elem, NULL));
+      ASSERT(rb_prev(lower) == NULL || value_less(rb_prev(lower), &k.rb_elem, NULL));
+    }
+
+    if (below + equal == expected) {
+      ASSERT(upper == NULL);
+    } else {
+      ASSERT(upper != NULL);
+      ASSERT(value_less(&k.rb_elem, upper, NULL));
+      ASSERT(rb_prev(upper) == NULL || !value_less(&k.rb_elem, rb_prev(upper), NULL));
+    }
+
+    ASSERT(found == (equal > 0 ? lower : NULL));
+  }
+}
+
+/* Uses a tree and then an ordered list as a priority queue of
+   CNT elements with random values: inserts them all, then
+   removes the least one until the queue is empty.  Reports the
+   average time per element for each phase. */
+static void benchmark(size_t cnt) {
+  struct value* values = malloc(sizeof *values * cnt);
+  struct rb_tree tree;
+  struct list list;
+  int64_t start, insert, remove;
+  int prev;
+  size_t i;
+
+  ASSERT(values != NULL);
+  for (i = 0; i < cnt; i++)
+    values[i].value = random_ulong() % cnt;
+
+  rb_init(&tree, value_less, NULL);
+  start = timer_now_ns();
+  for (i = 0; i < cnt; i++)
+    rb_insert(&tree, &values[i].rb_elem);
+  insert = timer_now_ns() - start;
+
+  prev = -1;
+  start = timer_now_ns();
+  for (i = 0; i < cnt; i++) {
+    struct value* v = rb_entry(rb_first(&tree), struct value, rb_elem);
+    rb_remove(&tree, &v->rb_elem);
+    ASSERT(v->value >= prev);
+    prev = v->value;
+  }
+  remove = timer_now_ns() - start;
+  ASSERT(rb_empty(&tree));
+  printf("rbtree %8zu %8lld %8lld\n", cnt, insert / (int64_t)cnt, remove / (int64_t)cnt);
+
+  list_init(&list);
+  start = timer_now_ns();
+  for (i = 0; i < cnt; i++)
+    list_insert_ordered(&list, &values[i].list_elem, value_list_less, NULL);
+  insert = timer_now_ns() - start;
+
+  prev = -1;
+  start = timer_now_ns();
+  for (i = 0; i < cnt; i++) {
+    struct value* v = list_entry(list_pop_front(&list), struct value, list_elem);
+    ASSERT(v->value >= prev);
+    prev = v->value;
+  }
+  remove = timer_now_ns() - start;
+  ASSERT(list_empty(&list));
+  printf("list   %8zu %8lld %8lld\n", cnt, insert / (int64_t)cnt, remove / (int64_t)cnt);
+
+  free(values);
+}
+
+/* Returns true if value A is less than value B, false
+   otherwise. */
+static bool value_less(const struct rb_elem* a_, const struct rb_elem* b_, void* aux UNUSED) {
+  const struct value* a = rb_entry(a_, struct value, rb_elem);
+  const struct value* b = rb_entry(b_, struct value, rb_elem);
+
+  return a->value < b->value;
+}
+
+/* Returns true if value A is less than value B, false
+   otherwise. */
+static bool value_list_less(const struct list_elem* a_, const struct list_elem* b_,
+                            void* aux UNUSED) {
+  const struct value* a = list_entry(a_, struct value, list_elem);
+  const struct value* b = list_entry(b_, struct value, list_elem);
+
+  return a->value < b->value;
+}
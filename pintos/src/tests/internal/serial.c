@@ -0,0 +1,48 @@
+/* Benchmark for console output through devices/serial.c.
+
+   Writes 1 MB to the console with putbuf(), in 64-byte lines, as
+   a process writing to its standard output would, and reports
+   the rate in characters per second.  The rate is limited by
+   how fast the serial port (or, under an emulator, the host)
+   drains the transmit queue, and by the interrupts needed to do
+   so.
+
+   This is not a test we will run on your submitted projects.
+   It is here for completeness.
+*/
+
+#undef NDEBUG
+#include <console.h>
+#include <stdio.h>
+#include <string.h>
+#include "devices/serial.h"
+#include "devices/timer.h"
+#include "threads/test.h"
+
+/* Total number of bytes to write. */
+#define TOTAL_BYTES (1024 * 1024)
+
+/* Bytes per line, including the new-line. */
+#define LINE_BYTES 64
+
+/* Benchmark console output. */
+void test(void) {
+  char line[LINE_BYTES];
+  int64_t start, elapsed;
+  int i;
+
+  memset(line, 'x', LINE_BYTES - 1);
+  line[LINE_BYTES - 1] = '\n';
+
+  start = timer_ticks();
+  for (i = 0; i < TOTAL_BYTES / LINE_BYTES; i++)
+    putbuf(line, LINE_BYTES);
+  serial_flush();
+  elapsed = timer_elapsed(start);
+  if (elapsed == 0)
+    elapsed = 1;
+
+  printf("%d bytes in %lld ms: %lld characters/s\n", TOTAL_BYTES,
+         (long long)elapsed * 1000 / TIMER_FREQ, (long long)TOTAL_BYTES * TIMER_FREQ / elapsed);
+  printf("serial: PASS\n");
+}
@@ -0,0 +1,112 @@
+/* Benchmark for the block functions in lib/string.c.
+
+   Times memcpy(), memmove() between overlapping blocks, memset(),
+   and memcmp() of equal blocks, on blocks from 8 bytes to 64 kB,
+   and reports the throughput of each in bytes per CPU cycle,
+   measured with the time stamp counter.  Each block is offset by
+   one byte from word alignment in a second run, to show the cost
+   of the unaligned head and tail.
+
+   This is not a test we will run on your submitted projects.
+   It is here for completeness.
+*/
+
+#undef NDEBUG
+#include <debug.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "threads/palloc.h"
+#include "threads/test.h"
+#include "threads/vaddr.h"
+
+/* Smallest and largest block sizes to time. */
+#define MIN_SIZE 8
+#define MAX_SIZE (64 * 1024)
+
+/* Bytes processed at each size, so that every size takes about
+   the same time. */
+#define BYTES_PER_SIZE (16 * 1024 * 1024)
+
+/* Pages for each of the two buffers, with room for the offset. */
+#define PAGE_CNT (MAX_SIZE / PGSIZE + 1)
+
+/* The functions timed. */
+enum op { OP_MEMCPY, OP_MEMMOVE, OP_MEMSET, OP_MEMCMP, OP_CNT };
+static const char* op_names[OP_CNT] = {"memcpy", "memmove", "memset", "memcmp"};
+
+static uint64_t time_op(enum op, uint8_t* a, uint8_t* b, size_t size);
+static uint64_t rdtsc(void);
+
+/* Benchmark memcpy(), memmove(), memset(), and memcmp(). */
+void test(void) {
+  uint8_t* a = palloc_get_multiple(PAL_ASSERT | PAL_ZERO, PAGE_CNT);
+  uint8_t* b = palloc_get_multiple(PAL_ASSERT | PAL_ZERO, PAGE_CNT);
+  int offset;
+
+  for (offset = 0; offset <= 1; offset++) {
+    enum op op;
+    size_t size;
+
+    printf("%s blocks, bytes per cycle:\n%-8s", offset ? "unaligned" : "aligned", "size");
+    for (op = 0; op < OP_CNT; op++)
+      printf(" %8s", op_names[op]);
+    printf("\n");
+
+    for (size = MIN_SIZE; size <= MAX_SIZE; size *= 2) {
+      printf("%-8zu", size);
+      for (op = 0; op < OP_CNT; op++) {
+        uint64_t bytes_per_kcycle = time_op(op, a + offset, b, size);
+        printf(" %4llu.%03llu", bytes_per_kcycle / 1000, bytes_per_kcycle % 1000);
+      }
+      printf("\n");
+    }
+  }
+
+  palloc_free_multiple(a, PAGE_CNT);
+  palloc_free_multiple(b, PAGE_CNT);
+  printf("string: PASS\n");
+}
+
+/* Runs OP on SIZE-byte blocks at A and B until BYTES_PER_SIZE
+   bytes have been processed, and returns the throughput in bytes
+   per thousand cycles. */
+static uint64_t time_op(enum op op, uint8_t* a, uint8_t* b, size_t size) {
+  size_t iterations = BYTES_PER_SIZE / size;
+  uint64_t start, cycles;
+  size_t i;
+
+  /* Equal blocks make memcmp() read all of both. */
+  if (op == OP_MEMCMP)
+    memcpy(b, a, size);
+
+  start = rdtsc();
+  for (i = 0; i < iterations; i++)
+    switch (op) {
+      case OP_MEMCPY:
+        memcpy(b, a, size);
+        break;
+      case OP_MEMMOVE:
+        /* Overlapping, so that the copy runs backward. */
+        memmove(a + 1, a, size);
+        break;
+      case OP_MEMSET:
+        memset(a, i, size);
+        break;
+      case OP_MEMCMP:
+        ASSERT(memcmp(a, b, size) == 0);
+        break;
+      default:
+        NOT_REACHED();
+    }
+  cycles = rdtsc() - start;
+
+  return cycles > 0 ? (uint64_t)BYTES_PER_SIZE * 1000 / cycles : 0;
+}
+
+/* Returns the time stamp counter. */
+static uint64_t rdtsc(void) {
+  uint64_t tsc;
+  asm volatile("rdtsc" : "=A"(tsc));
+  return tsc;
+}
@@ -13,13 +13,14 @@ static void vmsg(const char* format, va_list args, const char* suffix) {
      single buffer and output it in a single system call, because
      that'll (typically) ensure that it gets sent to the console
      atomically.  Otherwise kernel messages like "foo: exit(0)"
-     can end up being interleaved if we're unlucky. */
+     can end up being interleaved if we're unlucky.  Going
+     through hwrite() keeps it in order with printf() output. */
   static char buf[1024];
 
   snprintf(buf, sizeof buf, "(%s) ", test_name);
   vsnprintf(buf + strlen(buf), sizeof buf - strlen(buf), format, args);
   strlcpy(buf + strlen(buf), suffix, sizeof buf - strlen(buf));
-  write(STDOUT_FILENO, buf, strlen(buf));
+  hwrite(STDOUT_FILENO, buf, strlen(buf));
 }
 
 void msg(const char* format, ...) {
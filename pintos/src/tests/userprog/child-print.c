@@ -0,0 +1,36 @@
+/* Child process run by multi-print.
+   Writes LINE_CNT lines of about 100 bytes each to the console,
+   a few bytes per system call. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+
+const char* test_name = "child-print";
+
+/* Number of lines to write. */
+#define LINE_CNT 20
+
+/* Bytes written per system call. */
+#define PIECE_SIZE 7
+
+int main(int argc, char* argv[]) {
+  int child = argc > 1 ? atoi(argv[1]) : 0;
+  int i;
+
+  for (i = 0; i < LINE_CNT; i++) {
+    char line[128];
+    size_t ofs, len;
+
+    snprintf(line, sizeof line,
+             "child %d line %d: "
+             "xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx\n",
+             child, i);
+    len = strlen(line);
+    for (ofs = 0; ofs < len; ofs += PIECE_SIZE)
+      write(STDOUT_FILENO, line + ofs, len - ofs < PIECE_SIZE ? len - ofs : PIECE_SIZE);
+  }
+  return 0;
+}
@@ -0,0 +1,37 @@
+/* Reads the high-resolution clock until it has advanced past
+   several timer ticks, checking that it never runs backward and
+   that it also advances between ticks. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* How long to watch the clock, in nanoseconds. */
+#define DURATION (50 * 1000 * 1000)
+
+/* Readings after which to give up on the clock advancing. */
+#define MAX_READINGS (50 * 1000 * 1000)
+
+void test_main(void) {
+  int64_t start = clock_ns();
+  int64_t prev = start;
+  int readings = 0;
+  int steps = 0;
+
+  while (prev - start < DURATION) {
+    int64_t now = clock_ns();
+    if (now < prev)
+      fail("clock went backward from %lld to %lld ns", prev, now);
+    if (now > prev)
+      steps++;
+    if (++readings >= MAX_READINGS)
+      fail("clock stuck at %lld ns", now);
+    prev = now;
+  }
+
+  /* A clock that only advanced once per 10 ms timer tick would
+     have stepped about 5 times. */
+  if (steps < 50)
+    fail("clock advanced only %d times in %d ms", steps, DURATION / 1000000);
+  msg("clock advanced monotonically");
+}
@@ -0,0 +1,11 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(clock) begin
+(clock) clock advanced monotonically
+(clock) end
+clock: exit(0)
+EOF
+pass;
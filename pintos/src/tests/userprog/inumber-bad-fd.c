@@ -0,0 +1,11 @@
+/* Tries to get the inode number of an fd far beyond any that can
+   be open, which must terminate the process with exit code -1. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void test_main(void) {
+  inumber(0x20101234);
+  fail("should have exited with -1");
+}
@@ -0,0 +1,9 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(inumber-bad-fd) begin
+inumber-bad-fd: exit(-1)
+EOF
+pass;
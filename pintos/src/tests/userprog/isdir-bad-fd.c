@@ -0,0 +1,13 @@
+/* Tries to check whether the console output fd is a directory,
+   which must terminate the process with exit code -1, because fd
+   1 refers to no file. */
+
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void test_main(void) {
+  isdir(STDOUT_FILENO);
+  fail("should have exited with -1");
+}
@@ -0,0 +1,9 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(isdir-bad-fd) begin
+isdir-bad-fd: exit(-1)
+EOF
+pass;
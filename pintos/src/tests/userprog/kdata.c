@@ -0,0 +1,52 @@
+/* Reads the kernel data pages through the user library: checks
+   the values that do not change, then watches the tick count
+   advance for several ticks against the high-resolution clock.
+   Finally writes to the system-wide page, which is read-only, so
+   this should terminate the process with a -1 exit code. */
+
+#include <kdata.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Number of ticks to watch. */
+#define TICK_CNT 5
+
+/* Readings after which to give up on the tick count advancing. */
+#define MAX_READINGS (100 * 1000 * 1000)
+
+void test_main(void) {
+  int64_t start, prev, start_ns, elapsed_ns;
+  int freq = get_timer_freq();
+  int readings = 0;
+
+  CHECK(freq > 0, "timer frequency");
+  CHECK(get_boot_time() > 0, "boot time");
+  CHECK(getpid() > 0 && getppid() > 0 && getpid() != getppid(), "process identifiers");
+
+  /* Start timing at the beginning of a tick. */
+  prev = get_ticks();
+  while ((start = get_ticks()) == prev)
+    if (++readings >= MAX_READINGS)
+      fail("tick count stuck at %lld", prev);
+  start_ns = clock_ns();
+
+  for (prev = start; prev - start < TICK_CNT;) {
+    int64_t now = get_ticks();
+    if (now < prev)
+      fail("tick count went backward from %lld to %lld", prev, now);
+    if (++readings >= MAX_READINGS)
+      fail("tick count stuck at %lld", now);
+    prev = now;
+  }
+
+  /* TICK_CNT ticks cannot take much less than TICK_CNT tick
+     periods of real time. */
+  elapsed_ns = clock_ns() - start_ns;
+  if (elapsed_ns < (int64_t)(TICK_CNT - 1) * 1000000000 / freq)
+    fail("%d ticks took only %lld ns", TICK_CNT, elapsed_ns);
+  msg("tick count advanced");
+
+  *(volatile int*)KDATA_ADDR = 0;
+  fail("should have exited with -1");
+}
@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_USER_FAULTS => 1, [<<'EOF']);
+(kdata) begin
+(kdata) timer frequency
+(kdata) boot time
+(kdata) process identifiers
+(kdata) tick count advanced
+kdata: exit(-1)
+EOF
+pass;
@@ -0,0 +1,81 @@
+/* Allocates, resizes, and frees blocks of random sizes from 1
+   byte to several pages in random order with malloc(),
+   calloc(), realloc(), and free(), filling each block with a
+   pattern and checking that the pattern survives. */
+
+#include <random.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Number of blocks allocated at once, at most. */
+#define BLOCK_CNT 64
+
+/* Number of operations. */
+#define OP_CNT 4000
+
+static uint8_t* blocks[BLOCK_CNT];
+static size_t sizes[BLOCK_CNT];
+
+/* Returns a random block size, usually small. */
+static size_t random_size(void) {
+  return random_ulong() % 8 == 0 ? random_ulong() % 20000 + 1 : random_ulong() % 200 + 1;
+}
+
+/* Fails unless the first CNT bytes of block IDX hold its
+   pattern. */
+static void check_block(int idx, size_t cnt) {
+  size_t i;
+
+  for (i = 0; i < cnt; i++)
+    if (blocks[idx][i] != (uint8_t)idx)
+      fail("block %d byte %zu is 0x%02x, not 0x%02x", idx, i, blocks[idx][i], idx);
+}
+
+void test_main(void) {
+  int op, i;
+
+  random_init(0);
+  for (op = 0; op < OP_CNT; op++) {
+    int idx = random_ulong() % BLOCK_CNT;
+    size_t size = random_size();
+
+    if (blocks[idx] == NULL) {
+      if (op % 2) {
+        blocks[idx] = calloc(size, 1);
+        if (blocks[idx] == NULL)
+          fail("calloc(%zu, 1) failed", size);
+        for (i = 0; (size_t)i < size; i++)
+          if (blocks[idx][i] != 0)
+            fail("calloc'd byte %d is not zero", i);
+      } else {
+        blocks[idx] = malloc(size);
+        if (blocks[idx] == NULL)
+          fail("malloc(%zu) failed", size);
+      }
+      sizes[idx] = size;
+      memset(blocks[idx], idx, size);
+    } else if (op % 3 == 0) {
+      uint8_t* p = realloc(blocks[idx], size);
+      if (p == NULL)
+        fail("realloc to %zu bytes failed", size);
+      blocks[idx] = p;
+      check_block(idx, size < sizes[idx] ? size : sizes[idx]);
+      sizes[idx] = size;
+      memset(blocks[idx], idx, size);
+    } else {
+      check_block(idx, sizes[idx]);
+      free(blocks[idx]);
+      blocks[idx] = NULL;
+    }
+  }
+
+  for (i = 0; i < BLOCK_CNT; i++)
+    if (blocks[i] != NULL) {
+      check_block(i, sizes[i]);
+      free(blocks[i]);
+    }
+  msg("%d operations", OP_CNT);
+}
@@ -0,0 +1,11 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(malloc) begin
+(malloc) 4000 operations
+(malloc) end
+malloc: exit(0)
+EOF
+pass;
@@ -0,0 +1,24 @@
+/* Runs several child processes at once, each of which writes
+   long lines to the console in many small pieces, and checks
+   that every line comes out whole. */
+
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Number of child processes. */
+#define CHILD_CNT 4
+
+void test_main(void) {
+  pid_t children[CHILD_CNT];
+  int i;
+
+  for (i = 0; i < CHILD_CNT; i++) {
+    char cmd_line[32];
+    snprintf(cmd_line, sizeof cmd_line, "child-print %d", i);
+    CHECK((children[i] = exec(cmd_line)) != -1, "exec \"%s\"", cmd_line);
+  }
+  for (i = 0; i < CHILD_CNT; i++)
+    CHECK(wait(children[i]) == 0, "wait for child %d", i);
+}
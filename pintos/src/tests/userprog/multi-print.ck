@@ -0,0 +1,27 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+our ($test);
+my (@output) = read_text_file ("$test.output");
+common_checks ("run", @output);
+@output = get_core_output ("run", @output);
+
+my (%lines);
+my ($exits) = 0;
+local ($_);
+foreach (@output) {
+    next if /^\(multi-print\) (begin|end)$/ || /^multi-print: exit\(0\)$/;
+    if (/^child-print: exit\(0\)$/) {
+	$exits++;
+	next;
+    }
+    my ($child, $line) = /^child (\d) line (\d+): x{80}$/
+      or fail "Garbled output line: $_\n";
+    fail "Line $line of child $child printed twice.\n"
+      if $lines{"$child $line"}++;
+}
+fail scalar (keys %lines) . " lines printed instead of 80.\n"
+  if keys %lines != 80;
+fail "$exits children exited instead of 4.\n" if $exits != 4;
+pass;
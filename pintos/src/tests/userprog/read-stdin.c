@@ -0,0 +1,44 @@
+/* Reads lines from the console, as fed from read-stdin.in, and
+   checks that each read() returns exactly one edited line,
+   whether the line ends in CR LF, LF, or CR alone, and that
+   Ctrl+D at the start of a line reads as end of file. */
+
+#include <stdio.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Lines expected, in order, after editing. */
+static const char* expected[] = {
+    "crlf\n", /* Ends in CR LF. */
+    "lf\n",   /* Ends in LF. */
+    "cr\n",   /* Ends in CR alone. */
+    "abd\n",  /* "abc", backspace, "d". */
+    "kept\n", /* "xyz", Ctrl+U, "kept". */
+};
+
+#define LINE_CNT (sizeof expected / sizeof *expected)
+
+void test_main(void) {
+  char lines[LINE_CNT][64];
+  int sizes[LINE_CNT];
+  char eof_buf[64];
+  int eof_size;
+  size_t i;
+
+  /* Read everything first, so that the console's echo of the
+     input does not land in the middle of our messages. */
+  for (i = 0; i < LINE_CNT; i++)
+    sizes[i] = read(STDIN_FILENO, lines[i], sizeof lines[i]);
+  eof_size = read(STDIN_FILENO, eof_buf, sizeof eof_buf);
+
+  for (i = 0; i < LINE_CNT; i++) {
+    size_t len = strlen(expected[i]);
+    if (sizes[i] != (int)len || memcmp(lines[i], expected[i], len))
+      fail("read %zu returned %d bytes, expected \"%.*s\\n\"", i + 1, sizes[i],
+           (int)len - 1, expected[i]);
+    msg("read %zu: \"%.*s\\n\"", i + 1, (int)len - 1, expected[i]);
+  }
+  CHECK(eof_size == 0, "read at end of file returned %d", eof_size);
+}
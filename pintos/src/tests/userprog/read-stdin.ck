@@ -0,0 +1,22 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+our ($test);
+
+# Drop the console's echo of the input before comparing.
+my (@output) = read_text_file ("$test.output");
+common_checks ("run", @output);
+@output = grep (/^(\(read-stdin\) |read-stdin: exit|Execut)/, @output);
+compare_output ("run", \@output, [<<'EOF']);
+(read-stdin) begin
+(read-stdin) read 1: "crlf\n"
+(read-stdin) read 2: "lf\n"
+(read-stdin) read 3: "cr\n"
+(read-stdin) read 4: "abd\n"
+(read-stdin) read 5: "kept\n"
+(read-stdin) read at end of file returned 0
+(read-stdin) end
+read-stdin: exit(0)
+EOF
+pass;
@@ -0,0 +1,13 @@
+/* Tries to read a directory entry from a negative fd, which
+   must terminate the process with exit code -1. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void test_main(void) {
+  char name[READDIR_MAX_LEN + 1];
+
+  readdir(-1024, name);
+  fail("should have exited with -1");
+}
@@ -0,0 +1,42 @@
+/* Grows the heap with sbrk(), checks that the new memory is
+   zeroed and writable, and shrinks it again.  Then checks that
+   sbrk() refuses to move the break below the start of the heap
+   or into the stack, and that memory given back and taken again
+   is zeroed afresh. */
+
+#include <stdint.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Number of bytes to grow the heap by, a few pages and a bit. */
+#define SIZE (3 * 4096 + 100)
+
+/* Fails unless the CNT bytes at P are all zero. */
+static void check_zero(const uint8_t* p, size_t cnt) {
+  size_t i;
+
+  for (i = 0; i < cnt; i++)
+    if (p[i] != 0)
+      fail("heap byte %zu is 0x%02x, not zero", i, p[i]);
+}
+
+void test_main(void) {
+  uint8_t* start = sbrk(0);
+
+  CHECK(start != (void*)-1, "sbrk(0)");
+  CHECK(sbrk(SIZE) == start, "grow heap");
+  CHECK(sbrk(0) == start + SIZE, "break moved up");
+  check_zero(start, SIZE);
+  memset(start, 0xa5, SIZE);
+
+  CHECK(sbrk(-SIZE) == start + SIZE, "shrink heap");
+  CHECK(sbrk(0) == start, "break moved down");
+  CHECK(sbrk(-1) == (void*)-1, "shrink below start of heap");
+  CHECK(sbrk(INTPTR_MAX) == (void*)-1, "grow into stack");
+  CHECK(sbrk(0) == start, "break unchanged");
+
+  CHECK(sbrk(SIZE) == start, "grow heap again");
+  check_zero(start, SIZE);
+}
@@ -0,0 +1,19 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(sbrk) begin
+(sbrk) sbrk(0)
+(sbrk) grow heap
+(sbrk) break moved up
+(sbrk) shrink heap
+(sbrk) break moved down
+(sbrk) shrink below start of heap
+(sbrk) grow into stack
+(sbrk) break unchanged
+(sbrk) grow heap again
+(sbrk) end
+sbrk: exit(0)
+EOF
+pass;
@@ -0,0 +1,28 @@
+/* Makes a system call with SYSENTER while the trap flag is set.
+   SYSENTER does not clear the trap flag, so the kernel takes a
+   single-step trap at its entry point, which it must survive.
+   The call should then complete normally and return with the
+   trap flag clear, or the process would be killed by a debug
+   exception right after it. */
+
+#include <syscall-nr.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Trap flag in EFLAGS. */
+#define FLAG_TF 0x100
+
+void test_main(void) {
+  int retval;
+
+  /* Set %ecx and %edx before the trap flag, because every
+     instruction after POPFL in user mode would trap. */
+  asm volatile("pushl %[arg0]; pushl %[number]; "
+               "movl %%esp, %%ecx; movl $1f, %%edx; "
+               "pushfl; orl %[tf], (%%esp); popfl; "
+               "sysenter; 1: addl $8, %%esp"
+               : "=a"(retval)
+               : [number] "i"(SYS_PRACTICE), [arg0] "i"(41), [tf] "i"(FLAG_TF)
+               : "memory", "ecx", "edx");
+  CHECK(retval == 42, "practice(41) through sysenter with trap flag set");
+}
@@ -0,0 +1,11 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(sysenter-tf) begin
+(sysenter-tf) practice(41) through sysenter with trap flag set
+(sysenter-tf) end
+sysenter-tf: exit(0)
+EOF
+pass;
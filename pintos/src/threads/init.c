@@ -26,6 +26,7 @@
 #include "userprog/process.h"
 #include "userprog/exception.h"
 #include "userprog/gdt.h"
+#include "userprog/kdata.h"
 #include "userprog/syscall.h"
 #include "userprog/tss.h"
 #else
@@ -34,8 +35,10 @@
 #ifdef FILESYS
 #include "devices/block.h"
 #include "devices/ide.h"
+#include "devices/ramdisk.h"
 #include "filesys/filesys.h"
 #include "filesys/fsutil.h"
+#include "filesys/journal.h"
 #endif
 
 /* Page directory with kernel mappings only. */
@@ -52,8 +55,17 @@ static const char* scratch_bdev_name;
 #ifdef VM
 static const char* swap_bdev_name;
 #endif
+
+/* -ramdisk: Size in kB of the RAM disk to create for each role,
+   or 0 for none.  -ramdisk-latency: Delay per request to them,
+   in microseconds. */
+static size_t ramdisk_kb[BLOCK_ROLE_CNT];
+static unsigned ramdisk_latency;
 #endif /* FILESYS */
 
+/* -raw-input: Hand console input to readers unedited? */
+static bool raw_input;
+
 /* -ul: Maximum number of pages to put into palloc's user pool. */
 static size_t user_page_limit = SIZE_MAX;
 
@@ -66,6 +78,8 @@ static void run_actions(char** argv);
 static void usage(void);
 
 #ifdef FILESYS
+static void parse_ramdisk(const char* value);
+static void create_ramdisks(void);
 static void locate_block_devices(void);
 static void locate_block_device(enum block_type, const char* name);
 #endif
@@ -107,9 +121,12 @@ int main(void) {
   timer_init();
   kbd_init();
   input_init();
+  if (raw_input)
+    input_set_mode(INPUT_RAW);
 #ifdef USERPROG
   exception_init();
   syscall_init();
+  kdata_init();
 #endif
 
   /* Start thread scheduler and enable interrupts. */
@@ -119,6 +136,7 @@ int main(void) {
 
 #ifdef FILESYS
   /* Initialize file system. */
+  create_ramdisks();
   ide_init();
   locate_block_devices();
   filesys_init(format_filesys);
@@ -232,6 +250,12 @@ static char** parse_options(char** argv) {
       filesys_bdev_name = value;
     else if (!strcmp(name, "-scratch"))
       scratch_bdev_name = value;
+    else if (!strcmp(name, "-crash"))
+      journal_crash_after(atoi(value));
+    else if (!strcmp(name, "-ramdisk"))
+      parse_ramdisk(value);
+    else if (!strcmp(name, "-ramdisk-latency"))
+      ramdisk_latency = atoi(value);
 #ifdef VM
     else if (!strcmp(name, "-swap"))
       swap_bdev_name = value;
@@ -241,6 +265,8 @@ static char** parse_options(char** argv) {
       random_init(atoi(value));
     else if (!strcmp(name, "-mlfqs"))
       thread_mlfqs = true;
+    else if (!strcmp(name, "-raw-input"))
+      raw_input = true;
 #ifdef USERPROG
     else if (!strcmp(name, "-ul"))
       user_page_limit = atoi(value);
@@ -348,12 +374,17 @@ static void usage(void) {
          "  -f                 Format file system device during startup.\n"
          "  -filesys=BDEV      Use BDEV for file system instead of default.\n"
          "  -scratch=BDEV      Use BDEV for scratch instead of default.\n"
+         "  -crash=N           Lose power right after the Nth journal commit.\n"
+         "  -ramdisk=ROLE:KB   Use a KB kB RAM disk for ROLE (filesys, scratch, swap).\n"
+         "  -ramdisk-latency=US\n"
+         "                     Delay each RAM disk request by US microseconds.\n"
 #ifdef VM
          "  -swap=BDEV         Use BDEV for swap instead of default.\n"
 #endif
 #endif
          "  -rs=SEED           Set random number seed to SEED.\n"
          "  -mlfqs             Use multi-level feedback queue scheduler.\n"
+         "  -raw-input         Pass console input through without line editing.\n"
 #ifdef USERPROG
          "  -ul=COUNT          Limit user memory to COUNT pages.\n"
 #endif
@@ -362,6 +393,35 @@ static void usage(void) {
 }
 
 #ifdef FILESYS
+/* Parses VALUE, the argument to a -ramdisk option, which has the
+   form ROLE:KB. */
+static void parse_ramdisk(const char* value) {
+  const char* colon = value != NULL ? strchr(value, ':') : NULL;
+  enum block_type role;
+
+  if (colon == NULL)
+    PANIC("-ramdisk requires an argument of the form ROLE:KB");
+  for (role = 0; role < BLOCK_ROLE_CNT; role++) {
+    const char* role_name = block_type_name(role);
+    if (strlen(role_name) == (size_t)(colon - value) && !memcmp(value, role_name, colon - value))
+      break;
+  }
+  if (role == BLOCK_ROLE_CNT || role == BLOCK_KERNEL)
+    PANIC("-ramdisk: unknown role in `%s'", value);
+  ramdisk_kb[role] = atoi(colon + 1);
+}
+
+/* Creates the RAM disks requested with -ramdisk.  They are
+   created before any other block device, so that each becomes
+   the default for its role. */
+static void create_ramdisks(void) {
+  enum block_type role;
+
+  for (role = 0; role < BLOCK_ROLE_CNT; role++)
+    if (ramdisk_kb[role] > 0)
+      ramdisk_create(role, ramdisk_kb[role] * 1024 / BLOCK_SECTOR_SIZE, ramdisk_latency);
+}
+
 /* Figure out what block devices to cast in the various Pintos roles. */
 static void locate_block_devices(void) {
   locate_block_device(BLOCK_FILESYS, filesys_bdev_name);
@@ -32,6 +32,12 @@
 #include "threads/interrupt.h"
 #include "threads/thread.h"
 
+static heap_less_func waiter_less;
+
+/* Arrival order of threads waiting on semaphores, for waking
+   waiters of equal priority first-come, first-served. */
+static unsigned wait_seq;
+
 /* Initializes semaphore SEMA to VALUE.  A semaphore is a
    nonnegative integer along with two atomic operators for
    manipulating it:
@@ -45,7 +51,7 @@ void sema_init(struct semaphore* sema, unsigned value) {
   ASSERT(sema != NULL);
 
   sema->value = value;
-  list_init(&sema->waiters);
+  heap_init(&sema->waiters, waiter_less, NULL);
 }
 
 /* Down or "P" operation on a semaphore.  Waits for SEMA's value
@@ -63,7 +69,9 @@ void sema_down(struct semaphore* sema) {
 
   old_level = intr_disable();
   while (sema->value == 0) {
-    list_push_back(&sema->waiters, &thread_current()->elem);
+    struct thread* t = thread_current();
+    t->wait_seq = wait_seq++;
+    heap_push(&sema->waiters, &t->wait_elem);
     thread_block();
   }
   sema->value--;
@@ -93,7 +101,8 @@ bool sema_try_down(struct semaphore* sema) {
 }
 
 /* Up or "V" operation on a semaphore.  Increments SEMA's value
-   and wakes up one thread of those waiting for SEMA, if any.
+   and wakes up the highest-priority thread of those waiting for
+   SEMA, if any, in O(lg n) time for n waiters.
 
    This function may be called from an interrupt handler. */
 void sema_up(struct semaphore* sema) {
@@ -102,8 +111,8 @@ void sema_up(struct semaphore* sema) {
   ASSERT(sema != NULL);
 
   old_level = intr_disable();
-  if (!list_empty(&sema->waiters))
-    thread_unblock(list_entry(list_pop_front(&sema->waiters), struct thread, elem));
+  if (!heap_empty(&sema->waiters))
+    thread_unblock(heap_entry(heap_pop(&sema->waiters), struct thread, wait_elem));
   sema->value++;
   intr_set_level(old_level);
 }
@@ -139,6 +148,18 @@ static void sema_test_helper(void* sema_) {
   }
 }
 
+/* Returns true if waiting thread A should be woken before
+   waiting thread B: if it has higher priority, or the same
+   priority and began waiting earlier. */
+static bool waiter_less(const struct heap_elem* a_, const struct heap_elem* b_, void* aux UNUSED) {
+  const struct thread* a = heap_entry(a_, struct thread, wait_elem);
+  const struct thread* b = heap_entry(b_, struct thread, wait_elem);
+
+  if (a->priority != b->priority)
+    return a->priority > b->priority;
+  return (int)(a->wait_seq - b->wait_seq) < 0;
+}
+
 /* Initializes LOCK.  A lock can be held by at most a single
    thread at any given time.  Our locks are not "recursive", that
    is, it is an error for the thread currently holding a lock to
@@ -1,13 +1,14 @@
 #ifndef THREADS_SYNCH_H
 #define THREADS_SYNCH_H
 
+#include <heap.h>
 #include <list.h>
 #include <stdbool.h>
 
 /* A counting semaphore. */
 struct semaphore {
   unsigned value;      /* Current value. */
-  struct list waiters; /* List of waiting threads. */
+  struct heap waiters; /* Waiting threads, highest priority first. */
 };
 
 void sema_init(struct semaphore*, unsigned value);
@@ -7,6 +7,7 @@
 #include "threads/flags.h"
 #include "threads/interrupt.h"
 #include "threads/intr-stubs.h"
+#include "threads/malloc.h"
 #include "threads/palloc.h"
 #include "threads/switch.h"
 #include "threads/synch.h"
@@ -14,6 +15,9 @@
 #ifdef USERPROG
 #include "userprog/process.h"
 #endif
+#ifdef FILESYS
+#include "filesys/directory.h"
+#endif
 
 /* Random value for struct thread's `magic' member.
    Used to detect stack overflow.  See the big comment at the top
@@ -170,6 +174,14 @@ tid_t thread_create(const char* name, int priority, thread_func* function, void*
   init_thread(t, name, priority);
   tid = t->tid = allocate_tid();
   init_file_d(t);
+#ifdef USERPROG
+  t->parent_tid = thread_current()->tid;
+#endif
+#ifdef FILESYS
+  /* Start out in the creator's current directory. */
+  if (thread_current()->cwd != NULL)
+    t->cwd = dir_reopen(thread_current()->cwd);
+#endif
 
   /* Stack frame for kernel_thread(). */
   kf = alloc_frame(t, sizeof *kf);
@@ -508,13 +520,13 @@ static tid_t allocate_tid(void) {
 uint32_t thread_stack_ofs = offsetof(struct thread, stack);
 
 void init_file_d(struct thread* t) {
-  struct file** files = malloc(sizeof(struct file*) * 128);
+  struct file** files = calloc(FILE_D_CNT, sizeof(struct file*));
   t->file_d = files;
 }
 
 int add_file_d(struct file* file, struct thread* t) {
   struct file** files = t->file_d;
-  for (int i = 2; i < 128; i++) {
+  for (int i = 2; i < FILE_D_CNT; i++) {
     if (!files[i]) {
       files[i] = file;
     }
@@ -2,6 +2,7 @@
 #define THREADS_THREAD_H
 
 #include <debug.h>
+#include <heap.h>
 #include <list.h>
 #include <stdint.h>
 #include "threads/synch.h"
@@ -74,12 +75,12 @@ typedef int tid_t;
    the `magic' member of the running thread's `struct thread' is
    set to THREAD_MAGIC.  Stack  overflow will normally change this
    value, triggering the assertion. */
-/* The `elem' member has  dual purpose.  It can be an element in
-   the run queue (thread.c), or it can be an element in a
-   semaphore wait list (synch.c).  It can be used these two ways
-    only because they are mutually exclusive: only a thread in the
-   ready state is on the run queue, whereas only a thread in the
-   blocked state is on a semaphore wait list. */
+/* The `elem' member is an element in the run queue (thread.c).
+   A blocked thread waiting on a semaphore is instead in the
+   semaphore's heap of waiters (synch.c) through `wait_elem',
+   ordered by priority and then by `wait_seq', so that among
+   waiters of equal priority the first to arrive is woken
+   first. */
 struct thread {
   /* Owned by thread.c. */
   tid_t tid;                 /* Thread identifier. */
@@ -90,11 +91,23 @@ struct thread {
   struct list_elem allelem;  /* List element for all threads list. */
 
   /* Shared between thread.c and synch.c. */
-  struct list_elem elem; /* List elemt. */
+  struct list_elem elem;      /* List elemt. */
+  struct heap_elem wait_elem; /* Semaphore waiters heap element. */
+  unsigned wait_seq;          /* Semaphore arrival order. */
 #ifdef USERPROG
   /* Owned by userprog/process.c. */
   struct file** file_d;
-  uint32_t* pagedir; /* Page directory. */
+  uint32_t* pagedir;   /* Page directory. */
+  char* console_buf;   /* Buffered console output, or null. */
+  size_t console_len;  /* Number of bytes in console_buf. */
+  uint8_t* heap_start; /* Start of heap, just past the program. */
+  uint8_t* brk;        /* End of heap, the program break. */
+  tid_t parent_tid;    /* Thread that created this one. */
+#endif
+#ifdef FILESYS
+  /* Owned by filesys/filesys.c. */
+  struct dir* cwd;   /* Current directory, or null for the root. */
+  int journal_depth; /* Nesting of journal_begin() calls. */
 #endif
 
   /* Owned bythread.c. */
@@ -148,6 +161,7 @@ int thread_get_recent_cpu(void);
 int thread_get_load_avg(void);
 
 //Helper Functions for file descriptor array
+#define FILE_D_CNT 128 /* Number of entries in a file descriptor array. */
 void init_file_d(
     struct thread*
         t); //Initialize file descriptor array with 0 and 1 set to dummy values and rest with value null
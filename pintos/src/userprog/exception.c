@@ -2,6 +2,9 @@
 #include <inttypes.h>
 #include <stdio.h>
 #include "userprog/gdt.h"
+#include "userprog/process.h"
+#include "userprog/syscall.h"
+#include "threads/flags.h"
 #include "threads/interrupt.h"
 #include "threads/thread.h"
 
@@ -9,6 +12,7 @@
 static long long page_fault_cnt;
 
 static void kill(struct intr_frame*);
+static void debug_exception(struct intr_frame*);
 static void page_fault(struct intr_frame*);
 
 /* Registers handlers for interrupts that can be caused by user
@@ -40,7 +44,7 @@ void exception_init(void) {
      caused indirectly, e.g. #DE can be caused by dividing by
      0.  */
   intr_register_int(0, 0, INTR_ON, kill, "#DE Divide Error");
-  intr_register_int(1, 0, INTR_ON, kill, "#DB Debug Exception");
+  intr_register_int(1, 0, INTR_ON, debug_exception, "#DB Debug Exception");
   intr_register_int(6, 0, INTR_ON, kill, "#UD Invalid Opcode Exception");
   intr_register_int(7, 0, INTR_ON, kill, "#NM Device Not Available Exception");
   intr_register_int(11, 0, INTR_ON, kill, "#NP Segment Not Present");
@@ -74,6 +78,7 @@ static void kill(struct intr_frame* f) {
     case SEL_UCSEG:
       /* User's code segment, so it's a user exception, as we
          expected.  Kill the user process.  */
+      process_flush_console();
       printf("%s: dying due to interrupt %#04x (%s).\n", thread_name(), f->vec_no,
              intr_name(f->vec_no));
       intr_dump_frame(f);
@@ -96,6 +101,25 @@ static void kill(struct intr_frame* f) {
   }
 }
 
+/* Debug exception (#DB) handler.
+
+   A user program that executes SYSENTER with the trap flag set
+   takes a single-step trap in the kernel, at the start of
+   sysenter_entry, because SYSENTER leaves the flag alone.  This
+   is expected, not a kernel bug: we clear the trap flag in the
+   interrupted context and let sysenter_entry carry on.  Any
+   other debug exception is handled like most others. */
+static void debug_exception(struct intr_frame* f) {
+  uintptr_t eip = (uintptr_t)f->eip;
+
+  if (f->cs == SEL_KCSEG && eip >= (uintptr_t)sysenter_entry &&
+      eip <= (uintptr_t)sysenter_tf_clear) {
+    f->eflags &= ~FLAG_TF;
+    return;
+  }
+  kill(f);
+}
+
 /* Page fault handler.  This is a skeleton that must be filled in
    to implement virtual memory.  Some solutions to project 2 may
    also require modifying this code.
@@ -137,6 +161,7 @@ static void page_fault(struct intr_frame* f) {
   /* To implement virtual memory, delete the rest of the function
      body, and replace it with code that brings in the page to
      which fault_addr refers. */
+  process_flush_console();
   printf("Page fault at %p: %s error %s page in %s context.\n", fault_addr,
          not_present ? "not present" : "rights violation", write ? "writing" : "reading",
          user ? "user" : "kernel");
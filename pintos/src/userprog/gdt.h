@@ -4,12 +4,19 @@
 #include "threads/loader.h"
 
 /* Segment selectors.
-   More selectors are defined by the loader in loader.h. */
+   More selectors are defined by the loader in loader.h.
+
+   SYSENTER and SYSEXIT derive the kernel stack segment and the
+   user code and stack segments from the kernel code selector,
+   so SEL_KCSEG, SEL_KDSEG, SEL_UCSEG, and SEL_UDSEG must stay
+   in consecutive slots in that order. */
 #define SEL_UCSEG 0x1B /* User code selector. */
 #define SEL_UDSEG 0x23 /* User data selector. */
 #define SEL_TSS 0x28   /* Task-state segment. */
 #define SEL_CNT 6      /* Number of segments. */
 
+#ifndef __ASSEMBLER__
 void gdt_init(void);
+#endif
 
 #endif /* userprog/gdt.h */
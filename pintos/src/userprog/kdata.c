@@ -0,0 +1,63 @@
+#include "userprog/kdata.h"
+#include <debug.h>
+#include <kdata.h>
+#include "devices/rtc.h"
+#include "devices/timer.h"
+#include "threads/palloc.h"
+#include "userprog/pagedir.h"
+
+/* The system-wide kernel data page, mapped read-only into every
+   process at KDATA_ADDR.  See lib/kdata.h for its layout and for
+   how user programs read it. */
+static struct kdata* kdata;
+
+/* Allocates and initializes the system-wide kernel data page. */
+void kdata_init(void) {
+  kdata = palloc_get_page(PAL_ASSERT | PAL_ZERO);
+  kdata->timer_freq = TIMER_FREQ;
+  kdata->boot_time = rtc_get_time();
+}
+
+/* Publishes the timer tick count TICKS.  Called by the timer
+   interrupt handler on each tick. */
+void kdata_tick(int64_t ticks) {
+  kdata->ticks = ticks;
+
+  /* The load average changes at most once a second. */
+  if (ticks % TIMER_FREQ == 0)
+    kdata->load_avg = thread_get_load_avg();
+  kdata->seq++;
+}
+
+/* Maps the kernel data pages into the address space of T, which
+   must already have a page directory: the system-wide page at
+   KDATA_ADDR, and a new page at KDATA_PROC_ADDR describing T.
+   Both are read-only.  Returns true if successful, false if
+   memory runs out or either address is already in use. */
+bool kdata_map(struct thread* t) {
+  struct kdata_proc* proc;
+
+  if (pagedir_get_page(t->pagedir, KDATA_ADDR) != NULL ||
+      pagedir_get_page(t->pagedir, KDATA_PROC_ADDR) != NULL)
+    return false;
+
+  proc = palloc_get_page(PAL_USER | PAL_ZERO);
+  if (proc == NULL)
+    return false;
+  proc->pid = t->tid;
+  proc->ppid = t->parent_tid;
+  if (!pagedir_set_page(t->pagedir, KDATA_PROC_ADDR, proc, false)) {
+    palloc_free_page(proc);
+    return false;
+  }
+
+  return pagedir_set_page(t->pagedir, KDATA_ADDR, kdata, false);
+}
+
+/* Removes the system-wide kernel data page from page directory
+   PD, if it is mapped there, so that pagedir_destroy() does not
+   free it.  The per-process page is freed with the rest. */
+void kdata_unmap(uint32_t* pd) {
+  if (pagedir_get_page(pd, KDATA_ADDR) == kdata)
+    pagedir_clear_page(pd, KDATA_ADDR);
+}
@@ -0,0 +1,13 @@
+#ifndef USERPROG_KDATA_H
+#define USERPROG_KDATA_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "threads/thread.h"
+
+void kdata_init(void);
+void kdata_tick(int64_t ticks);
+bool kdata_map(struct thread*);
+void kdata_unmap(uint32_t* pd);
+
+#endif /* userprog/kdata.h */
@@ -1,4 +1,5 @@
 #include "userprog/process.h"
+#include <console.h>
 #include <debug.h>
 #include <inttypes.h>
 #include <round.h>
@@ -6,6 +7,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "userprog/gdt.h"
+#include "userprog/kdata.h"
 #include "userprog/pagedir.h"
 #include "userprog/tss.h"
 #include "filesys/directory.h"
@@ -14,14 +16,19 @@
 #include "threads/flags.h"
 #include "threads/init.h"
 #include "threads/interrupt.h"
+#include "threads/malloc.h"
 #include "threads/palloc.h"
 #include "threads/synch.h"
 #include "threads/thread.h"
 #include "threads/vaddr.h"
 
+/* Size of each process's console output buffer. */
+#define CONSOLE_BUF_SIZE 256
+
 static struct semaphore temporary;
 static thread_func start_process NO_RETURN;
 static bool load(const char* cmdline, void (**eip)(void), void** esp);
+static void flush_console(struct thread*, size_t cnt);
 
 /* Starts a new thread running a user program loaded from
    FILENAME.  The new thread may be scheduled (and may even exit)
@@ -118,11 +125,84 @@ void process_exit(void) {
          that's been freed (and cleared). */
     cur->pagedir = NULL;
     pagedir_activate(NULL);
+    kdata_unmap(pd);
     pagedir_destroy(pd);
   }
+
+  process_flush_console();
+  free(cur->console_buf);
+  cur->console_buf = NULL;
+
+  dir_close(cur->cwd);
+  cur->cwd = NULL;
   sema_up(&temporary);
 }
 
+/* Writes the SIZE bytes in BUFFER to the console on behalf of
+   the current process.
+
+   Output is line buffered: it is held in a per-process buffer
+   until a new-line is written or the buffer fills, and then
+   passed to putbuf() in one piece.  This keeps lines from
+   different processes writing at the same time from being mixed
+   together, and takes the console lock once per line instead of
+   once per write.  Any partial line is written by
+   process_flush_console(), which must be called before the
+   process exits or prints anything else. */
+void process_write_console(const void* buffer_, size_t size) {
+  struct thread* t = thread_current();
+  const char* buffer = buffer_;
+
+  if (t->console_buf == NULL) {
+    t->console_buf = malloc(CONSOLE_BUF_SIZE);
+    if (t->console_buf == NULL) {
+      putbuf(buffer, size);
+      return;
+    }
+  }
+
+  while (size > 0) {
+    size_t n = CONSOLE_BUF_SIZE - t->console_len;
+    size_t end;
+
+    if (n > size)
+      n = size;
+    memcpy(t->console_buf + t->console_len, buffer, n);
+    t->console_len += n;
+    buffer += n;
+    size -= n;
+
+    /* Write out everything through the last new-line, or all of
+       it if the buffer is full. */
+    if (t->console_len == CONSOLE_BUF_SIZE)
+      flush_console(t, t->console_len);
+    else {
+      for (end = t->console_len; end > t->console_len - n; end--)
+        if (t->console_buf[end - 1] == '\n') {
+          flush_console(t, end);
+          break;
+        }
+    }
+  }
+}
+
+/* Writes any console output buffered by the current process. */
+void process_flush_console(void) {
+  struct thread* t = thread_current();
+  if (t->console_len > 0)
+    flush_console(t, t->console_len);
+}
+
+/* Writes the first CNT bytes of T's console buffer to the
+   console and removes them from the buffer. */
+static void flush_console(struct thread* t, size_t cnt) {
+  ASSERT(cnt <= t->console_len);
+
+  putbuf(t->console_buf, cnt);
+  t->console_len -= cnt;
+  memmove(t->console_buf, t->console_buf + cnt, t->console_len);
+}
+
 /* Sets up the CPU for running user code in the current
    thread.
    This function is called on every context switch. */
@@ -217,6 +297,7 @@ bool load(const char* args, void (**eip)(void), void** esp) {
   char* saveptr;
   char* file_name;
   char* args_copy;
+  uint8_t* heap_start = NULL;
   /* Allocate and activate page directory. */
   t->pagedir = pagedir_create();
   if (t->pagedir == NULL)
@@ -291,6 +372,10 @@ bool load(const char* args, void (**eip)(void), void** esp) {
           }
           if (!load_segment(file, file_page, (void*)mem_page, read_bytes, zero_bytes, writable))
             goto done;
+
+          /* The heap starts on the page after the last segment. */
+          if ((uint8_t*)mem_page + read_bytes + zero_bytes > heap_start)
+            heap_start = (uint8_t*)mem_page + read_bytes + zero_bytes;
         } else
           goto done;
         break;
@@ -300,6 +385,11 @@ bool load(const char* args, void (**eip)(void), void** esp) {
   /* Set up stack. */
   if (!setup_stack(esp, args))
     goto done;
+  t->heap_start = t->brk = heap_start;
+
+  /* Map the kernel data pages. */
+  if (!kdata_map(t))
+    goto done;
 
   /* Start address. */
   *eip = (void (*)(void))ehdr.e_entry;
@@ -479,3 +569,51 @@ static bool install_page(void* upage, void* kpage, bool writable) {
   return (pagedir_get_page(t->pagedir, upage) == NULL &&
           pagedir_set_page(t->pagedir, upage, kpage, writable));
 }
+
+static void unmap_pages(uint8_t* start, uint8_t* end);
+
+/* Moves the current process's program break, the end of its
+   heap, by INCREMENT bytes, which may be negative.  Pages that
+   the heap grows into are mapped, zeroed, at once, and pages it
+   shrinks out of are freed.  Returns the old break, or
+   (void*) -1 without moving the break if the heap would shrink
+   below its start or grow into the stack, or if memory runs
+   out. */
+void* process_sbrk(intptr_t increment) {
+  struct thread* t = thread_current();
+  uint8_t* old_brk = t->brk;
+  uint8_t* limit = (uint8_t*)PHYS_BASE - PGSIZE;
+  uint8_t* new_brk;
+  uint8_t* upage;
+
+  if (increment < 0 ? (uintptr_t)(old_brk - t->heap_start) < -(uintptr_t)increment
+                    : (uintptr_t)(limit - old_brk) < (uintptr_t)increment)
+    return (void*)-1;
+  new_brk = old_brk + increment;
+
+  for (upage = pg_round_up(old_brk); upage < new_brk; upage += PGSIZE) {
+    uint8_t* kpage = palloc_get_page(PAL_USER | PAL_ZERO);
+    if (kpage == NULL || !install_page(upage, kpage, true)) {
+      palloc_free_page(kpage);
+      unmap_pages(pg_round_up(old_brk), upage);
+      return (void*)-1;
+    }
+  }
+  unmap_pages(pg_round_up(new_brk), pg_round_up(old_brk));
+
+  t->brk = new_brk;
+  return old_brk;
+}
+
+/* Unmaps and frees the current process's pages from START up to
+   END, both page-aligned. */
+static void unmap_pages(uint8_t* start, uint8_t* end) {
+  uint32_t* pd = thread_current()->pagedir;
+  uint8_t* upage;
+
+  for (upage = start; upage < end; upage += PGSIZE) {
+    void* kpage = pagedir_get_page(pd, upage);
+    pagedir_clear_page(pd, upage);
+    palloc_free_page(kpage);
+  }
+}
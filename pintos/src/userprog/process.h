@@ -8,4 +8,9 @@ int process_wait(tid_t);
 void process_exit(void);
 void process_activate(void);
 
+void process_write_console(const void*, size_t);
+void process_flush_console(void);
+
+void* process_sbrk(intptr_t increment);
+
 #endif /* userprog/process.h */
@@ -1,15 +1,19 @@
 #include "userprog/syscall.h"
 #include <stdio.h>
 #include <syscall-nr.h>
+#include "devices/input.h"
+#include "devices/timer.h"
 #include "threads/interrupt.h"
 #include "threads/thread.h"
 #include "threads/synch.h"
 #include "threads/vaddr.h"
+#include "filesys/directory.h"
 #include "filesys/filesys.h"
 #include "filesys/file.h"
+#include "filesys/inode.h"
+#include "userprog/process.h"
 
 struct lock lock;
-static void syscall_handler(struct intr_frame*);
 bool syscall_create(const char* file, unsigned initial_size);
 bool syscall_remove(const char* file);
 int syscall_open(const char* file, struct thread* t);
@@ -18,6 +22,11 @@ int syscall_read(int fd, void* buffer, unsigned size, struct thread* t);
 int syscall_write(int fd, void* buffer, unsigned size, struct thread* t);
 void syscall_seek(int fd, unsigned position, struct thread* t);
 unsigned syscall_tell(int fd, struct thread* t);
+bool syscall_chdir(const char* dir);
+bool syscall_mkdir(const char* dir);
+bool syscall_readdir(int fd, char* name, struct thread* t);
+bool syscall_isdir(int fd, struct thread* t);
+int syscall_inumber(int fd, struct thread* t);
 void validate_ptr(void* ptr, int size);
 
 void syscall_init(void) {
@@ -36,14 +45,12 @@ void validate_ptr(void* ptr, int size) {
 
 void general_exit(int status) {
   //barebone exit, don't know if we have to write anything, modify later
+  process_flush_console();
   printf("%s: exit(%d)\n", &thread_current()->name, status);
   thread_exit();
 }
 
 bool syscall_create(const char* file, unsigned initial_size) {
-  if (strlen(file) > 14) {
-    return false;
-  }
   return filesys_create(file, initial_size);
 }
 
@@ -54,7 +61,7 @@ int syscall_open(const char* file, struct thread* t) {
   if (open_file == NULL) {
     return -1;
   }
-  int file_descriptor = add_file_d(file, t);
+  int file_descriptor = add_file_d(open_file, t);
   return file_descriptor;
 }
 
@@ -68,8 +75,13 @@ int syscall_filesize(int fd, struct thread* t) {
 
 int syscall_read(int fd, void* buffer, unsigned size, struct thread* t) {
   if (fd == 0) {
-    //not sure what to pass in
-    return input_getc();
+    //show any prompt first, and let other processes make system
+    //calls while this one waits for the user to type
+    process_flush_console();
+    lock_release(&lock);
+    int result = input_read(buffer, size);
+    lock_acquire(&lock);
+    return result;
   } else {
     struct file* file_struct = t->file_d[fd];
     if (!file_struct) {
@@ -82,13 +94,16 @@ int syscall_read(int fd, void* buffer, unsigned size, struct thread* t) {
 
 int syscall_write(int fd, void* buffer, unsigned size, struct thread* t) {
   if (fd == 1) {
-    putbuf(buffer, size);
+    process_write_console(buffer, size);
   } else {
     struct file* file_struct = t->file_d[fd];
     if (!file_struct) {
       general_exit(-1);
       return -1;
     }
+    if (inode_is_dir(file_get_inode(file_struct))) {
+      return -1;
+    }
     int result = file_write(file_struct, buffer, size);
     return result;
   }
@@ -119,7 +134,50 @@ void syscall_close(int fd, struct thread* t) {
   remove_file_d(fd, t);
 }
 
-static void syscall_handler(struct intr_frame* f UNUSED) {
+bool syscall_chdir(const char* dir) { return filesys_chdir(dir); }
+
+bool syscall_mkdir(const char* dir) { return filesys_mkdir(dir); }
+
+/* Returns the file that T has open as FD.  Terminates the process
+   if FD is not a descriptor for an open file, including the
+   console descriptors 0 and 1, which have no file. */
+static struct file* lookup_fd(int fd, struct thread* t) {
+  if (fd < 2 || fd >= FILE_D_CNT || t->file_d[fd] == NULL)
+    general_exit(-1);
+  return t->file_d[fd];
+}
+
+bool syscall_readdir(int fd, char* name, struct thread* t) {
+  struct file* file_struct = lookup_fd(fd, t);
+  if (!inode_is_dir(file_get_inode(file_struct))) {
+    return false;
+  }
+  //the fd's file position doubles as its directory position
+  struct dir* dir = dir_open(inode_reopen(file_get_inode(file_struct)));
+  if (!dir) {
+    return false;
+  }
+  dir_seek(dir, file_tell(file_struct));
+  bool result = dir_readdir(dir, name);
+  file_seek(file_struct, dir_tell(dir));
+  dir_close(dir);
+  return result;
+}
+
+bool syscall_isdir(int fd, struct thread* t) {
+  struct file* file_struct = lookup_fd(fd, t);
+  return inode_is_dir(file_get_inode(file_struct));
+}
+
+int syscall_inumber(int fd, struct thread* t) {
+  struct file* file_struct = lookup_fd(fd, t);
+  return inode_get_inumber(file_get_inode(file_struct));
+}
+
+/* Handles the system call whose number and arguments are on the
+   user stack at F->esp.  Reached through the `int $0x30' gate or
+   directly from sysenter_entry in userprog/sysenter.S. */
+void syscall_handler(struct intr_frame* f UNUSED) {
   lock_acquire(&lock);
   uint32_t* args = ((uint32_t*)f->esp);
   validate_ptr(args, 4);
@@ -188,7 +246,7 @@ static void syscall_handler(struct intr_frame* f UNUSED) {
       int fd_read = args[1];
       void* buffer_read = args[2];
       unsigned size_read = args[3];
-      if (!fd_read || !size_read) {
+      if (!size_read) {
         general_exit(-1);
       }
       validate_ptr((char*)buffer_read, (size_read + 1));
@@ -232,6 +290,41 @@ static void syscall_handler(struct intr_frame* f UNUSED) {
       }
       syscall_close(fd_close, thread_current());
       break;
+    case SYS_CHDIR:
+      validate_ptr(args + 1, 4);
+      validate_ptr((char*)args[1], (strlen((char*)args[1]) + 1));
+      f->eax = syscall_chdir((char*)args[1]);
+      break;
+    case SYS_MKDIR:
+      validate_ptr(args + 1, 4);
+      validate_ptr((char*)args[1], (strlen((char*)args[1]) + 1));
+      f->eax = syscall_mkdir((char*)args[1]);
+      break;
+    case SYS_READDIR:
+      validate_ptr(args + 1, 4);
+      validate_ptr(args + 2, 4);
+      int fd_readdir = args[1];
+      char* name_readdir = (char*)args[2];
+      validate_ptr(name_readdir, NAME_MAX + 1);
+      f->eax = syscall_readdir(fd_readdir, name_readdir, thread_current());
+      break;
+    case SYS_ISDIR:
+      validate_ptr(args + 1, 4);
+      f->eax = syscall_isdir(args[1], thread_current());
+      break;
+    case SYS_INUMBER:
+      validate_ptr(args + 1, 4);
+      f->eax = syscall_inumber(args[1], thread_current());
+      break;
+    case SYS_CLOCK:
+      validate_ptr(args + 1, 4);
+      validate_ptr((int64_t*)args[1], sizeof(int64_t));
+      *(int64_t*)args[1] = timer_now_ns();
+      break;
+    case SYS_SBRK:
+      validate_ptr(args + 1, 4);
+      f->eax = (uint32_t)process_sbrk((intptr_t)args[1]);
+      break;
     default:
       break;
   }
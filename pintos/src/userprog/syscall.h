@@ -1,6 +1,11 @@
 #ifndef USERPROG_SYSCALL_H
 #define USERPROG_SYSCALL_H
 
+struct intr_frame;
+
 void syscall_init(void);
+void syscall_handler(struct intr_frame*);
+void sysenter_entry(void);
+void sysenter_tf_clear(void);
 
 #endif /* userprog/syscall.h */
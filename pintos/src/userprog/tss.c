@@ -1,7 +1,9 @@
 #include "userprog/tss.h"
 #include <debug.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include "userprog/gdt.h"
+#include "userprog/syscall.h"
 #include "threads/thread.h"
 #include "threads/palloc.h"
 #include "threads/vaddr.h"
@@ -74,6 +76,19 @@ struct tss {
 /* Kernel TSS. */
 static struct tss* tss;
 
+/* Model-specific registers that configure SYSENTER.
+   See [IA32-v3a] 5.8.7 "Performing Fast Calls to System
+   Procedures with the SYSENTER and SYSEXIT Instructions". */
+#define MSR_SYSENTER_CS 0x174  /* Kernel code selector. */
+#define MSR_SYSENTER_ESP 0x175 /* Kernel stack pointer. */
+#define MSR_SYSENTER_EIP 0x176 /* Kernel entry point. */
+
+/* True if the CPU has SYSENTER and we have set it up. */
+static bool use_sysenter;
+
+static bool sysenter_present(void);
+static void wrmsr(uint32_t msr, uint32_t value);
+
 /* Initializes the kernel TSS. */
 void tss_init(void) {
   /* Our TSS is never used in a call gate or task gate, so only a
@@ -82,6 +97,15 @@ void tss_init(void) {
   tss = palloc_get_page(PAL_ASSERT | PAL_ZERO);
   tss->ss0 = SEL_KDSEG;
   tss->bitmap = 0xdfff;
+
+  /* Set up the fast system call path, if the CPU has one.
+     tss_update() sets its stack pointer. */
+  use_sysenter = sysenter_present();
+  if (use_sysenter) {
+    wrmsr(MSR_SYSENTER_CS, SEL_KCSEG);
+    wrmsr(MSR_SYSENTER_EIP, (uint32_t)sysenter_entry);
+  }
+
   tss_update();
 }
 
@@ -92,8 +116,36 @@ struct tss* tss_get(void) {
 }
 
 /* Sets the ring 0 stack pointer in the TSS to point to the end
-   of the thread stack. */
+   of the thread stack.  SYSENTER does not consult the TSS, so
+   the same stack pointer goes in its MSR too.  That way SYSENTER
+   arrives on a real stack, which matters if a debug exception
+   interrupts sysenter_entry before it has done anything. */
 void tss_update(void) {
   ASSERT(tss != NULL);
   tss->esp0 = (uint8_t*)thread_current() + PGSIZE;
+  if (use_sysenter)
+    wrmsr(MSR_SYSENTER_ESP, (uint32_t)tss->esp0);
+}
+
+/* Returns true if the CPU supports SYSENTER and SYSEXIT,
+   according to CPUID, false otherwise. */
+static bool sysenter_present(void) {
+  uint32_t eax = 1, ebx, ecx, edx;
+  int family, model, stepping;
+
+  asm volatile("cpuid" : "+a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx));
+  if ((edx & (1u << 11)) == 0)
+    return false;
+
+  /* The earliest Pentium Pro processors report the SEP flag
+     without supporting the instructions. */
+  family = (eax >> 8) & 0xf;
+  model = (eax >> 4) & 0xf;
+  stepping = eax & 0xf;
+  return !(family == 6 && model < 3 && stepping < 3);
+}
+
+/* Writes VALUE to model-specific register MSR. */
+static void wrmsr(uint32_t msr, uint32_t value) {
+  asm volatile("wrmsr" : : "c"(msr), "a"(value), "d"(0));
 }